@@ -13,128 +13,96 @@ module;
 #include <vector>
 #include <string>
 #include <utility>
-#include <cmath>
 #include <algorithm>
 #include <QPainter>
 #include <QCoreApplication>
 #include <QFileInfo>
-#include <limits>
+#include <cstdint>
 #include <QFontMetrics>
+#include <QDialog>
+#include <QPlainTextEdit>
+#include <QFontDatabase>
+#include <QColor>
+#include <memory>
+#include <string_view>
+#include <QWindow>
+#include <QScreen>
+#include <QEvent>
+#include <QShowEvent>
+#include <QHideEvent>
 
 export module GUIFrame;
 
 import TimerWorker;
 import Settings;
-
-static QString formatTime(double seconds, int precision) {
-    const double factor = std::pow(10.0, precision);
-    const double truncated = std::floor(seconds * factor) / factor;
-    int totalSeconds = static_cast<int>(truncated);
-    int minutes = totalSeconds / 60;
-    int secs = totalSeconds % 60;
-    double fractional = truncated - totalSeconds;
-
-    QString fractStr = QString::number(fractional, 'f', precision).mid(1); // Skip leading "0"
-    return QString("%1:%2%3")
-        .arg(minutes)
-        .arg(secs, 2, 10, QChar('0'))
-        .arg(fractStr);
-}
-
-static double truncateSeconds(double seconds, int precision) {
-    if (precision <= 0) return std::floor(seconds);
-    const double factor = std::pow(10.0, precision);
-    return std::floor(seconds * factor) / factor;
-}
-
-static QString formatTimeCompactLeadingZero(double seconds, int precision) {
-    const double absSeconds = std::abs(seconds);
-    if (absSeconds < 60.0) {
-        const double t = truncateSeconds(absSeconds, precision);
-        return QString::number(t, 'f', precision); // keeps leading zero (e.g., 0.0 / 0.00 / 0.000)
-    }
-    return formatTime(truncateSeconds(absSeconds, precision), precision);
+import PerfTracer;
+import TimerDisplay;
+import SplitTable;
+import Instrumentation;
+import TimeFormat;
+
+// Time and delta texts for the split rows, which change only on events. The timers format into a
+// buffer on every refresh instead, see GlyphLine::setText(std::string_view).
+static QString compactText(Duration d, int precision) {
+    char text[kDurationTextMax];
+    return QString::fromLatin1(text, static_cast<qsizetype>(formatDurationCompact(d, precision, text)));
 }
 
-static QString formatDelta(double seconds, int precision) {
-    const double absSeconds = std::abs(seconds);
-    const QString sign = (seconds < 0.0) ? "-" : "+";
-    return sign + formatTime(absSeconds, precision);
-}
-
-static QString formatDeltaCompact(double seconds, int precision) {
-    const double absSeconds = std::abs(seconds);
-    QString core;
-    if (absSeconds < 60.0) {
-        const double t = truncateSeconds(absSeconds, precision);
-        core = QString::number(t, 'f', precision);
-        if (absSeconds < 10.0) {
-            if (core.startsWith("0")) core.remove(0, 1); // remove leading zero before decimal
-            while (core.endsWith("0")) core.chop(1);     // trim trailing zeros
-            if (core.endsWith(".")) core.chop(1);        // trim dangling dot
-        }
-    } else {
-        core = formatTime(truncateSeconds(absSeconds, precision), precision);
-    }
-    const QString sign = (seconds < 0.0) ? "-" : "+";
-    return sign + core;
-}
-
-static std::string trimString(const std::string& s) {
-    const auto start = s.find_first_not_of(" \t");
-    if (start == std::string::npos) return {};
-    const auto end = s.find_last_not_of(" \t");
-    return s.substr(start, end - start + 1);
-}
-
-static bool tryParseTime(const std::string& s, double& outSeconds) {
-    const std::string t = trimString(s);
-    if (t.empty() || t == "-") return false;
-    try {
-        const auto colonPos = t.find(':');
-        if (colonPos == std::string::npos) {
-            outSeconds = std::stod(t);
-            return true;
-        }
-        const std::string minStr = t.substr(0, colonPos);
-        const std::string secStr = t.substr(colonPos + 1);
-        const double minutes = std::stod(minStr);
-        const double seconds = std::stod(secStr);
-        outSeconds = minutes * 60.0 + seconds;
-        return true;
-    } catch (...) {
-        return false;
-    }
+static QString deltaText(Duration d, int precision) {
+    char text[kDurationTextMax];
+    return QString::fromLatin1(text, static_cast<qsizetype>(formatDelta(d, precision, text)));
 }
 
 export class GridWidget : public QWidget {
 private:
     QGridLayout* layout;
-    QLabel* totalTimeLabel;
-    QLabel* segmentTimeLabel;
-    QLabel* totalLabel;      // "Total:" label at the bottom
-    QLabel* totalValueLabel; // The actual total time value
-
-    std::vector<QLabel*> splitNameLabels;
-    std::vector<QLabel*> splitTimeLabels;
-
-    QTimer* refreshTimer;
+    GlyphLine* totalTimeLine;
+    GlyphLine* segmentTimeLine;
+    QLabel* totalLabel;         // "Total:" label at the bottom
+    GlyphLine* totalValueLine;  // The actual total time value
+
+    // Every split in the model, WINDOW_SIZE of them on screen
+    SplitTableModel splitModel;
+    SplitTableView* splitView = nullptr;
+
+    // Digits for the two timers, the split times and the total, rendered once and blitted on every refresh
+    std::unique_ptr<GlyphAtlas> timerGlyphs;
+    std::unique_ptr<GlyphAtlas> splitGlyphs;
+    std::unique_ptr<GlyphAtlas> totalGlyphs;
+
+    // Redrawn when the worker queues an event (see setTimerEventNotifier), plus on every tick of this
+    // timer while the time is counting and the window can be seen. Otherwise nothing runs at all.
+    QTimer* animationTimer;
     QFont boldFont;
 
-    // Precision and gui interval controlled by settings.two_decimal_points
+    // Precision controlled by settings.two_decimal_points
     int mainTimerPrecision = 1; // 1 or 2 decimal places for big timers
-    int refreshIntervalMs = 100; // 100ms (10Hz) or 50ms (20Hz)
+
+    // What the window is doing, and what each state has cost the GUI thread so far
+    enum DisplayState { DISPLAY_IDLE, DISPLAY_ANIMATING, DISPLAY_HIDDEN, DISPLAY_STATE_COUNT };
+
+    struct DisplayStateStats_s {
+
+        int64_t     wallNs      = 0;
+        int64_t     cpuNs       = 0;
+        uint64_t    refreshes   = 0;
+
+    };
+
+    DisplayState displayState = DISPLAY_IDLE;
+    DisplayStateStats_s displayStats[DISPLAY_STATE_COUNT];
+    int64_t displayStateSinceNs = 0;
+    int64_t displayStateSinceCpuNs = 0;
 
     // Split management
-    std::vector<std::pair<std::string, std::string>> immutableSplits;
-    std::vector<double> defaultSplitTimes;
+    std::vector<SplitSetting_s> immutableSplits;
 
     // Tracking state
     size_t lastObservedSplitIndex = 0;
-    size_t windowStart = 0; // Index into immutableSplits for the top of the visible window
     static constexpr size_t WINDOW_SIZE = 11;
-    std::vector<double> completedSplitTimes;
-    double lastSplitTime = 0.0; // For segment calculation
+    std::vector<Duration> completedSplitTimes;
+    Duration lastSplitTime; // For segment calculation
+    uint64_t seenDroppedEvents = 0; // worker events lost to a full ring, see updateDisplay()
 
     // For dragging the window
     QPoint dragPosition;
@@ -146,14 +114,14 @@ private:
 
     // Color cache (linked to settings)
     QString headingColor;
-    QString totalTimerIdleColor;
-    QString totalTimerActiveColor;
-    QString segmentTimerIdleColor;
-    QString segmentTimerActiveColor;
-    QString splitsMapsColor;
-    QString splitsTimesColor;
+    QRgb totalTimerIdleColor;
+    QRgb totalTimerActiveColor;
+    QRgb segmentTimerIdleColor;
+    QRgb segmentTimerActiveColor;
+    QRgb splitsMapsColor;
+    QRgb splitsTimesColor;
     QString totalLabelColor;
-    QString totalValueColor;
+    QRgb totalValueColor;
 
 public:
     GridWidget(QWidget* parent = nullptr) : QWidget(parent) {
@@ -175,14 +143,8 @@ public:
         QFont splitsFont = boldFont;
         splitsFont.setPointSizeF(boldFont.pointSizeF() * (8.5 / 10.0));
 
-        // Choose precision and GUI refresh interval based on settings.two_decimal_points
-        if (settings.two_decimal_points) {
-            mainTimerPrecision = 2;
-            refreshIntervalMs = 50; // 20 Hz
-        } else {
-            mainTimerPrecision = 1;
-            refreshIntervalMs = 100; // 10 Hz
-        }
+        // Choose precision based on settings.two_decimal_points
+        mainTimerPrecision = settings.two_decimal_points ? 2 : 1;
 
         // Timer font: double the size of the base bold font for the two main timers
         QFont timerFont = boldFont;
@@ -190,14 +152,18 @@ public:
 
         // Cache colors from settings with sensible fallbacks
         headingColor            = QString::fromStdString(settings.heading_color.empty()                 ? "#FFFFFF" : settings.heading_color);
-        totalTimerIdleColor     = QString::fromStdString(settings.total_timer_idle_color.empty()        ? "green"   : settings.total_timer_idle_color);
-        totalTimerActiveColor   = QString::fromStdString(settings.total_timer_active_color.empty()      ? "#39FF14" : settings.total_timer_active_color);
-        segmentTimerIdleColor   = QString::fromStdString(settings.segment_timer_idle_color.empty()      ? "#4169E1" : settings.segment_timer_idle_color);
-        segmentTimerActiveColor = QString::fromStdString(settings.segment_timer_active_color.empty()    ? "#00BFFF" : settings.segment_timer_active_color);
-        splitsMapsColor         = QString::fromStdString(settings.splits_maps_color.empty()             ? "#FFFFFF" : settings.splits_maps_color);
-        splitsTimesColor        = QString::fromStdString(settings.splits_times_color.empty()            ? "#FFFFFF" : settings.splits_times_color);
+        totalTimerIdleColor     = toRgb(settings.total_timer_idle_color.empty()        ? "green"   : settings.total_timer_idle_color);
+        totalTimerActiveColor   = toRgb(settings.total_timer_active_color.empty()      ? "#39FF14" : settings.total_timer_active_color);
+        segmentTimerIdleColor   = toRgb(settings.segment_timer_idle_color.empty()      ? "#4169E1" : settings.segment_timer_idle_color);
+        segmentTimerActiveColor = toRgb(settings.segment_timer_active_color.empty()    ? "#00BFFF" : settings.segment_timer_active_color);
+        splitsMapsColor         = toRgb(settings.splits_maps_color.empty()             ? "#FFFFFF" : settings.splits_maps_color);
+        splitsTimesColor        = toRgb(settings.splits_times_color.empty()            ? "#FFFFFF" : settings.splits_times_color);
         totalLabelColor         = QString::fromStdString(settings.total_color.empty()                   ? "#FFD700" : settings.total_color);
-        totalValueColor         = QString::fromStdString(settings.total_time_color.empty()              ? "#FFD700" : settings.total_time_color);
+        totalValueColor         = toRgb(settings.total_time_color.empty()              ? "#FFD700" : settings.total_time_color);
+
+        timerGlyphs = std::make_unique<GlyphAtlas>(timerFont);
+        splitGlyphs = std::make_unique<GlyphAtlas>(splitsFont);
+        totalGlyphs = std::make_unique<GlyphAtlas>(boldFont);
 
         // Top group: keep title and category together so resizing won't separate them
         QWidget* topGroup = new QWidget(this);
@@ -228,70 +194,41 @@ public:
         spacerCatTotal->setFixedHeight(2); // reduced gap
         layout->addWidget(spacerCatTotal, 2, 0, 1, 2);
 
-        // Total time label (row 3 now) - larger and right-centered
-        totalTimeLabel = new QLabel(formatTimeCompactLeadingZero(0.0, mainTimerPrecision), this);
-        totalTimeLabel->setFont(timerFont);
-        totalTimeLabel->setStyleSheet(QString("QLabel { color: %1; }").arg(totalTimerIdleColor));
-        totalTimeLabel->setAlignment(Qt::AlignRight | Qt::AlignVCenter);
-        layout->addWidget(totalTimeLabel, 3, 0, 1, 2);
+        // Total time (row 3 now) - larger and right-centered
+        totalTimeLine = new GlyphLine(*timerGlyphs, this);
+        totalTimeLine->setText(compactText(Duration(), mainTimerPrecision), totalTimerIdleColor);
+        layout->addWidget(totalTimeLine, 3, 0, 1, 2);
 
-        // Segment time label (row 4 now)
+        // Segment time (row 4 now)
         if (settings.segment_time) {
             // Segment timer: larger and right-centered to match total timer
-            segmentTimeLabel = new QLabel(formatTimeCompactLeadingZero(0.0, mainTimerPrecision), this);
-            segmentTimeLabel->setFont(timerFont);
-            segmentTimeLabel->setStyleSheet(QString("QLabel { color: %1; }").arg(segmentTimerIdleColor));
-            segmentTimeLabel->setAlignment(Qt::AlignRight | Qt::AlignVCenter);
-            layout->addWidget(segmentTimeLabel, 4, 0, 1, 2);
+            segmentTimeLine = new GlyphLine(*timerGlyphs, this);
+            segmentTimeLine->setText(compactText(Duration(), mainTimerPrecision), segmentTimerIdleColor);
+            layout->addWidget(segmentTimeLine, 4, 0, 1, 2);
         } else {
-            segmentTimeLabel = nullptr;
+            segmentTimeLine = nullptr;
         }
 
         // Copy splits into immutable storage
         immutableSplits = settings.splits;
-        defaultSplitTimes.clear();
-        defaultSplitTimes.reserve(immutableSplits.size());
-        for (const auto& split : immutableSplits) {
-            double seconds = 0.0;
-            if (tryParseTime(split.second, seconds)) {
-                defaultSplitTimes.push_back(seconds);
-            } else {
-                defaultSplitTimes.push_back(std::numeric_limits<double>::quiet_NaN());
-            }
-        }
 
         // Initialize splits table if enabled (startRow shifted to leave spacer after segment)
         int startRow = (settings.segment_time ? 6 : 4);
-        size_t visibleCount = 0;
         if (settings.show_splits && !immutableSplits.empty()) {
-            visibleCount = std::min(immutableSplits.size(), WINDOW_SIZE);
-            for (size_t i = 0; i < visibleCount; ++i) {
-                QLabel* nameLabel = new QLabel(QString::fromStdString(immutableSplits[i].first), this);
-                nameLabel->setFont(splitsFont);
-                nameLabel->setStyleSheet(QString("QLabel { color: %1; }").arg(splitsMapsColor));
-                layout->addWidget(nameLabel, startRow + static_cast<int>(i), 0);
-                splitNameLabels.push_back(nameLabel);
-
-                QString defaultText = QString::fromStdString(immutableSplits[i].second);
-                if (i < defaultSplitTimes.size() && std::isfinite(defaultSplitTimes[i])) {
-                    defaultText = formatTimeCompactLeadingZero(defaultSplitTimes[i], 3);
-                }
-                QLabel* timeLabel = new QLabel(this);
-                timeLabel->setFont(splitsFont);
-                timeLabel->setStyleSheet(QString("QLabel { color: %1; }").arg(splitsTimesColor));
-                timeLabel->setAlignment(Qt::AlignRight);
-                timeLabel->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Preferred);
-                timeLabel->setTextFormat(Qt::RichText);
-                timeLabel->setText(buildSplitTimeHtml(splitsFont, defaultText, false, "", ""));
-                layout->addWidget(timeLabel, startRow + static_cast<int>(i), 1);
-                splitTimeLabels.push_back(timeLabel);
-            }
+            std::vector<SplitRow_s> rows;
+            rows.reserve(immutableSplits.size());
+            for (size_t i = 0; i < immutableSplits.size(); ++i) rows.push_back(pendingRow(i));
+            splitModel.assign(std::move(rows));
+
+            splitView = new SplitTableView(splitModel, *splitGlyphs, splitsFont, splitsMapsColor, splitsTimesColor,
+                                           std::min(immutableSplits.size(), WINDOW_SIZE), layout->spacing(), this);
+            layout->addWidget(splitView, startRow, 0, 1, 2);
         }
 
         // Place Total independently from splits: compute spacer row and total row
         int spacerRow;
-        if (visibleCount > 0) {
-            spacerRow = startRow + static_cast<int>(visibleCount); // spacer after last split
+        if (splitView) {
+            spacerRow = startRow + 1; // spacer after the split table
         } else {
             // No splits visible: place spacer after timers (leave one empty row)
             spacerRow = (settings.segment_time ? 5 : 4);
@@ -308,11 +245,8 @@ public:
         totalLabel->setAlignment(Qt::AlignLeft);
         layout->addWidget(totalLabel, totalRow, 0);
 
-        totalValueLabel = new QLabel("", this);
-        totalValueLabel->setFont(boldFont);
-        totalValueLabel->setStyleSheet(QString("QLabel { color: %1; }").arg(totalValueColor));
-        totalValueLabel->setAlignment(Qt::AlignRight);
-        layout->addWidget(totalValueLabel, totalRow, 1);
+        totalValueLine = new GlyphLine(*totalGlyphs, this);
+        layout->addWidget(totalValueLine, totalRow, 1);
 
         // Prevent extra height from being distributed across split rows
         for (int r = 0; r <= totalRow; ++r) {
@@ -359,10 +293,35 @@ public:
             }
         }
 
-        // Setup 10Hz refresh timer (100ms intervals)
-        refreshTimer = new QTimer(this);
-        connect(refreshTimer, &QTimer::timeout, this, &GridWidget::updateDisplay);
-        refreshTimer->start(refreshIntervalMs);
+        // Started and stopped by updateAnimation(), the first refresh comes with showEvent()
+        animationTimer = new QTimer(this);
+        animationTimer->setTimerType(Qt::PreciseTimer);
+        connect(animationTimer, &QTimer::timeout, this, &GridWidget::updateDisplay);
+
+        // Runs on the worker thread, so it only queues the refresh for this one
+        setTimerEventNotifier([this] { QMetaObject::invokeMethod(this, [this] { updateDisplay(); }, Qt::QueuedConnection); });
+
+        displayStateSinceNs = perfNow();
+        displayStateSinceCpuNs = threadCpuTimeNs();
+    }
+
+    ~GridWidget() override {
+        setTimerEventNotifier({});
+    }
+
+    // GUI thread time, CPU time and refreshes per display state, for the Stats view and stats_*.txt
+    std::string formatDisplayStats() {
+        accountDisplayState();
+
+        static constexpr const char* names[DISPLAY_STATE_COUNT] = { "idle", "animating", "hidden" };
+        QString text = "display (GUI thread):\n";
+        for (size_t i = 0; i < DISPLAY_STATE_COUNT; ++i) {
+            const DisplayStateStats_s& d = displayStats[i];
+            text += QString::asprintf("  %-10s %10.1f s %10llu refreshes %10.1f ms cpu %8.3f %%\n",
+                                      names[i], d.wallNs / 1e9, static_cast<unsigned long long>(d.refreshes),
+                                      d.cpuNs / 1e6, d.wallNs ? 100.0 * d.cpuNs / d.wallNs : 0.0);
+        }
+        return text.toStdString();
     }
 
 protected:
@@ -409,15 +368,22 @@ protected:
         );
 
         QAction* minimizeAction = contextMenu.addAction("Minimize");
+        QAction* saveTraceAction = contextMenu.addAction("Save Trace");
+        QAction* saveTickReportAction = contextMenu.addAction("Save Tick Report");
+        QAction* statsAction = contextMenu.addAction("Stats");
         QAction* closeAction = contextMenu.addAction("Close");
 
         connect(minimizeAction, &QAction::triggered, this, &QWidget::showMinimized);
+        connect(saveTraceAction, &QAction::triggered, this, [] { requestTraceDump(); });
+        connect(saveTickReportAction, &QAction::triggered, this, [] { saveTickReport(); });
+        connect(statsAction, &QAction::triggered, this, &GridWidget::showStats);
         connect(closeAction, &QAction::triggered, this, &QWidget::close);
 
         contextMenu.exec(event->globalPos());
     }
 
     void paintEvent(QPaintEvent* event) override {
+        PerfSpan span("paint");
         QPainter painter(this);
         painter.setCompositionMode(QPainter::CompositionMode_Source);
         if (backgroundLoaded) {
@@ -426,178 +392,229 @@ protected:
         QWidget::paintEvent(event);
     }
 
+    // Visibility changes decide whether the animation runs, each one is followed by a refresh
+    void showEvent(QShowEvent* event) override {
+        QWidget::showEvent(event);
+        // expose events go to the native window, which exists from the first show on
+        if (windowHandle()) windowHandle()->installEventFilter(this);
+        updateDisplay();
+    }
+
+    void hideEvent(QHideEvent* event) override {
+        QWidget::hideEvent(event);
+        updateDisplay();
+    }
+
+    void changeEvent(QEvent* event) override {
+        QWidget::changeEvent(event);
+        if (event->type() == QEvent::WindowStateChange) updateDisplay();
+    }
+
+    bool eventFilter(QObject* watched, QEvent* event) override {
+        if (watched == windowHandle() && event->type() == QEvent::Expose) updateDisplay();
+        return QWidget::eventFilter(watched, event);
+    }
+
 private:
-    void setSplitTimeLabel(size_t splitIdx, double displayTime) {
-        if (splitIdx < windowStart) return;
-        const size_t labelIdx = splitIdx - windowStart;
-        if (labelIdx >= splitTimeLabels.size()) return;
-
-        QLabel* label = splitTimeLabels[labelIdx];
-        QString text = formatTimeCompactLeadingZero(displayTime, 3);
-
-        if (splitIdx < defaultSplitTimes.size() && std::isfinite(defaultSplitTimes[splitIdx])) {
-            const double delta = displayTime - defaultSplitTimes[splitIdx];
-            const QString deltaStr = formatDeltaCompact(delta, 3);
-            const QString color = (delta < 0.0) ? "#00FF00" : "#FF0000";
-            text = buildSplitTimeHtml(label->font(), text, true, deltaStr, color);
-            label->setTextFormat(Qt::RichText);
+    // Worker stage latencies and counters (formatStats()) and display costs, refreshed once a second while the window is open
+    void showStats() {
+        auto* dialog = new QDialog(this);
+        dialog->setAttribute(Qt::WA_DeleteOnClose);
+        dialog->setWindowTitle("nxTimer Stats");
+        dialog->resize(720, 520);
+
+        auto* text = new QPlainTextEdit(dialog);
+        text->setReadOnly(true);
+        text->setLineWrapMode(QPlainTextEdit::NoWrap);
+        text->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+
+        auto* dialogLayout = new QVBoxLayout(dialog);
+        dialogLayout->addWidget(text);
+
+        auto refresh = [this, text] { text->setPlainText(QString::fromStdString(formatStats() + formatDisplayStats())); };
+        refresh();
+
+        auto* statsTimer = new QTimer(dialog);
+        connect(statsTimer, &QTimer::timeout, dialog, refresh);
+        statsTimer->start(1000);
+
+        dialog->show();
+    }
+
+    // Split 'splitIdx' before it's run: its time from the splits table, or the table's text as is
+    SplitRow_s pendingRow(size_t splitIdx) const {
+        const SplitSetting_s& split = immutableSplits[splitIdx];
+        const QString text = split.target ? compactText(*split.target, 3) : QString::fromStdString(split.time);
+        return { QString::fromStdString(split.name), text, QString(), 0 };
+    }
+
+    // Split 'splitIdx' once run, from completedSplitTimes: absolute or segment time, and the delta to the table's time
+    SplitRow_s completedRow(size_t splitIdx) const {
+        const SplitSetting_s& split = immutableSplits[splitIdx];
+        const Duration completedTime = completedSplitTimes[splitIdx];
+        Duration displayTime;
+        if (settings.splits_total) {
+            displayTime = completedTime;
         } else {
-            label->setTextFormat(Qt::RichText);
-            text = buildSplitTimeHtml(label->font(), text, false, "", "");
+            Duration prevTime = (splitIdx > 0) ? completedSplitTimes[splitIdx - 1] : Duration();
+            displayTime = completedTime - prevTime;
         }
 
-        label->setText(text);
+        SplitRow_s row = { QString::fromStdString(split.name), compactText(displayTime, 3), QString(), 0 };
+        if (split.target) {
+            const Duration delta = displayTime - *split.target;
+            row.delta = "(" + deltaText(delta, 3) + ")";
+            row.deltaColor = delta.negative() ? qRgb(0x00, 0xFF, 0x00) : qRgb(0xFF, 0x00, 0x00);
+        }
+        return row;
     }
 
-    static QString buildSplitTimeHtml(const QFont& font, const QString& timeText, bool hasDelta, const QString& deltaStr, const QString& color) {
-        const QFontMetrics fm(font);
-        const int timeWidth = fm.horizontalAdvance("0:00.000");
-        const int gapWidth = fm.horizontalAdvance("  ");
-        const int deltaWidth = fm.horizontalAdvance("(-0:00.000)");
-        const QString deltaCell = hasDelta
-            ? QString("<span style=\"color:%1;\">(%2)</span>").arg(color, deltaStr)
-            : QString("&nbsp;");
-        return QString(
-            "<div align=\"right\">"
-            "<table cellpadding=\"0\" cellspacing=\"0\"><tr>"
-            "<td width=\"%1\" align=\"right\">%2</td>"
-            "<td width=\"%3\"></td>"
-            "<td width=\"%4\" align=\"right\">%5</td>"
-            "</tr></table>"
-            "</div>"
-        ).arg(deltaWidth).arg(deltaCell).arg(gapWidth).arg(timeWidth).arg(timeText);
+    static QRgb toRgb(const std::string& name) {
+        return QColor(QString::fromStdString(name)).rgba();
     }
 
-    // Rebuild all visible split labels from the current windowStart
-    void rebuildSplitLabels() {
-        size_t visibleCount = splitNameLabels.size();
-        for (size_t i = 0; i < visibleCount; ++i) {
-            size_t splitIdx = windowStart + i; // index into immutableSplits (0-based)
-            if (splitIdx >= immutableSplits.size()) break;
-
-            splitNameLabels[i]->setText(QString::fromStdString(immutableSplits[splitIdx].first));
-
-            // completedSplitTimes is indexed by lastObservedSplitIndex (1-based split index)
-            // split 1 (immutableSplits[0]) completes at completedSplitTimes[0], etc.
-            if (splitIdx < completedSplitTimes.size()) {
-                double completedTime = completedSplitTimes[splitIdx];
-                double displayTime;
-                if (settings.splits_total) {
-                    displayTime = completedTime;
-                } else {
-                    double prevTime = (splitIdx > 0) ? completedSplitTimes[splitIdx - 1] : 0.0;
-                    displayTime = completedTime - prevTime;
-                }
-                setSplitTimeLabel(splitIdx, displayTime);
-            } else {
-                splitTimeLabels[i]->setTextFormat(Qt::RichText);
-                QString defaultText = QString::fromStdString(immutableSplits[splitIdx].second);
-                if (splitIdx < defaultSplitTimes.size() && std::isfinite(defaultSplitTimes[splitIdx])) {
-                    defaultText = formatTimeCompactLeadingZero(defaultSplitTimes[splitIdx], 3);
-                }
-                splitTimeLabels[i]->setText(buildSplitTimeHtml(splitTimeLabels[i]->font(), defaultText, false, "", ""));
-            }
+    // Adds the time since the last call to the current display state
+    void accountDisplayState() {
+        const int64_t now = perfNow();
+        const int64_t cpu = threadCpuTimeNs();
+        displayStats[displayState].wallNs += now - displayStateSinceNs;
+        displayStats[displayState].cpuNs += cpu - displayStateSinceCpuNs;
+        displayStateSinceNs = now;
+        displayStateSinceCpuNs = cpu;
+    }
+
+    // Monitor rate (60-240 Hz) unless settings.display_rate fixes one
+    int animationIntervalMs() const {
+        int hz = settings.display_rate;
+        if (hz == 0) hz = screen() ? std::clamp(qRound(screen()->refreshRate()), 60, 240) : 60;
+        return std::max(1, 1000 / hz);
+    }
+
+    // The animation only runs while the time is counting and the window is exposed: not hidden, not
+    // minimized and, where the platform reports it, not fully covered. Paused on a loading screen or
+    // stopped, the display changes only with worker events.
+    void updateAnimation(bool counting) {
+        const bool exposed = isVisible() && !isMinimized() && windowHandle() && windowHandle()->isExposed();
+        const DisplayState next = !exposed ? DISPLAY_HIDDEN : counting ? DISPLAY_ANIMATING : DISPLAY_IDLE;
+        if (next != displayState) {
+            accountDisplayState();
+            displayState = next;
         }
+
+        if (next != DISPLAY_ANIMATING) {
+            animationTimer->stop();
+            return;
+        }
+        const int interval = animationIntervalMs();
+        if (!animationTimer->isActive() || animationTimer->interval() != interval) animationTimer->start(interval);
     }
 
+public:
+    // Pulls the worker's events and latest state into the window. Runs on worker events, animation
+    // ticks and visibility changes; public so nxTimerBenchWindow can drive and time it.
     void updateDisplay() {
-        double totalTime = timerState.accumulatedTime.load();
-        bool isRunning = timerState.timerRunning.load();
-        bool isPaused = timerState.gameTimePaused.load();
-        bool displayTotal = timerState.displayTotal.load();
-        size_t currentSplitIndex = timerState.currentSplitIndex.load();
-
-        // Update total time display
-        totalTimeLabel->setText(formatTimeCompactLeadingZero(totalTime, mainTimerPrecision));
-        if (isRunning && !isPaused) {
-            totalTimeLabel->setStyleSheet(QString("QLabel { color: %1; }").arg(totalTimerActiveColor));
-        } else {
-            totalTimeLabel->setStyleSheet(QString("QLabel { color: %1; }").arg(totalTimerIdleColor));
+        PerfSpan span("updateDisplay");
+        ++displayStats[displayState].refreshes;
+
+        // Armed before draining, so an event queued from here on wakes us again
+        armTimerEventNotifier();
+
+        // Splits first, in the order they happened, each with the game time of the tick it happened at
+        TimerEvent_s event;
+        while (popTimerEvent(event)) applySplitIndex(event.splitIndex, Duration::fromNs(event.timeNs));
+
+        // one read, so time, split index and flags all come from the same worker tick
+        const TimerSnapshot_s snapshot = readTimerSnapshot();
+
+        const Duration totalTime = Duration::fromNs(snapshot.accumulatedNs);
+        bool isRunning = snapshot.timerRunning;
+        bool isPaused = snapshot.gameTimePaused;
+        bool displayTotal = snapshot.displayTotal;
+        size_t currentSplitIndex = snapshot.currentSplitIndex;
+
+        // The GUI stalled long enough for the event ring to overflow: catch up from the published index.
+        // The snapshot was read after draining, so it is never older than the events applied above.
+        if (droppedTimerEvents() != seenDroppedEvents) {
+            seenDroppedEvents = droppedTimerEvents();
+            applySplitIndex(currentSplitIndex, totalTime);
         }
 
+        // Update total time display: formatted on the stack, and only the digits that changed get repainted
+        const bool counting = isRunning && !isPaused;
+        char text[kDurationTextMax];
+        totalTimeLine->setText(std::string_view(text, formatDurationCompact(totalTime, mainTimerPrecision, text)),
+                               counting ? totalTimerActiveColor : totalTimerIdleColor);
+
         // Update segment time display
-        if (segmentTimeLabel) {
-            double segmentTime = totalTime - lastSplitTime;
-            segmentTimeLabel->setText(formatTimeCompactLeadingZero(segmentTime, mainTimerPrecision));
-            if (isRunning && !isPaused) {
-                segmentTimeLabel->setStyleSheet(QString("QLabel { color: %1; }").arg(segmentTimerActiveColor));
-            } else {
-                segmentTimeLabel->setStyleSheet(QString("QLabel { color: %1; }").arg(segmentTimerIdleColor));
-            }
+        if (segmentTimeLine) {
+            const Duration segmentTime = totalTime - lastSplitTime;
+            segmentTimeLine->setText(std::string_view(text, formatDurationCompact(segmentTime, mainTimerPrecision, text)),
+                                     counting ? segmentTimerActiveColor : segmentTimerIdleColor);
         }
 
         // Update Total label visibility
-        if (totalValueLabel) {
-            if (displayTotal) {
-                totalValueLabel->setText(formatTimeCompactLeadingZero(totalTime, 3));
-            } else {
-                totalValueLabel->setText("");
-            }
+        if (totalValueLine) {
+            totalValueLine->setText(displayTotal ? std::string_view(text, formatDurationCompact(totalTime, 3, text)) : std::string_view(),
+                                    totalValueColor);
         }
 
-        // Reset tracking on timer reset (currentSplitIndex == 0)
-        if (currentSplitIndex == 0 && lastObservedSplitIndex > 0) {
+        updateAnimation(counting);
+    }
+
+private:
+
+    // Brings the split rows to 'splitIndex': records 'time' for every split passed going forward,
+    // drops recorded times going back (undo), clears everything on a reset (index 0). Only the rows
+    // that change are touched, and the table scrolls by shifting its rows.
+    void applySplitIndex(size_t splitIndex, Duration time) {
+        // Reset tracking on timer reset (splitIndex == 0)
+        if (splitIndex == 0 && lastObservedSplitIndex > 0) {
+            for (size_t i = 0; i < completedSplitTimes.size(); ++i) splitModel.setRow(i, pendingRow(i));
+
             lastObservedSplitIndex = 0;
-            lastSplitTime = 0.0;
-            windowStart = 0;
+            lastSplitTime = Duration();
             completedSplitTimes.clear();
 
-            if (settings.show_splits) rebuildSplitLabels();
+            if (splitView) splitView->setTop(0);
             return;
         }
 
         if (!settings.show_splits) return;
 
-        // Handle undo: currentSplitIndex decreased
-        if (currentSplitIndex < lastObservedSplitIndex) {
-            while (lastObservedSplitIndex > currentSplitIndex) {
+        // Handle undo: splitIndex decreased
+        if (splitIndex < lastObservedSplitIndex) {
+            while (lastObservedSplitIndex > splitIndex) {
                 lastObservedSplitIndex--;
 
                 // Pop the last completed split time
                 if (!completedSplitTimes.empty()) completedSplitTimes.pop_back();
-                lastSplitTime = completedSplitTimes.empty() ? 0.0 : completedSplitTimes.back();
-
-                // Scroll window back if needed:
-                // windowStart should be max(0, lastObservedSplitIndex - WINDOW_SIZE + 1)
-                // but only go back if we were scrolled forward
-                size_t desiredWindowStart = (lastObservedSplitIndex >= WINDOW_SIZE)
-                    ? lastObservedSplitIndex - WINDOW_SIZE + 1
-                    : 0;
-                // Only scroll back, never forward during undo
-                if (desiredWindowStart < windowStart) {
-                    windowStart = desiredWindowStart;
-                }
+                lastSplitTime = completedSplitTimes.empty() ? Duration() : completedSplitTimes.back();
+
+                splitModel.setRow(lastObservedSplitIndex, pendingRow(lastObservedSplitIndex));
             }
-            rebuildSplitLabels();
+
+            // Scroll back only if the next split went out of view: the top should be
+            // max(0, lastObservedSplitIndex - WINDOW_SIZE + 1), but never scroll forward during undo
+            const size_t desiredTop = (lastObservedSplitIndex >= WINDOW_SIZE)
+                ? lastObservedSplitIndex - WINDOW_SIZE + 1
+                : 0;
+            if (splitView && desiredTop < splitView->top()) splitView->setTop(desiredTop);
             return;
         }
 
         // Handle forward splits
-        while (lastObservedSplitIndex < currentSplitIndex && lastObservedSplitIndex < immutableSplits.size()) {
+        while (lastObservedSplitIndex < splitIndex && lastObservedSplitIndex < immutableSplits.size()) {
             // Record the completed split time (index into completedSplitTimes == immutableSplits index)
-            completedSplitTimes.push_back(totalTime);
-
-            // Update the label for this split
-            size_t labelIdx = lastObservedSplitIndex - windowStart;
-            if (labelIdx < splitTimeLabels.size()) {
-                double displayTime;
-                if (settings.splits_total) {
-                    displayTime = totalTime;
-                } else {
-                    displayTime = totalTime - lastSplitTime;
-                }
-                setSplitTimeLabel(lastObservedSplitIndex, displayTime);
-            }
+            completedSplitTimes.push_back(time);
+            splitModel.setRow(lastObservedSplitIndex, completedRow(lastObservedSplitIndex));
 
-            lastSplitTime = totalTime;
+            lastSplitTime = time;
             lastObservedSplitIndex++;
 
-            // Scroll forward: once we've completed splits beyond WINDOW_SIZE,
-            // advance the window so the next upcoming split is always visible at the bottom
-            if (lastObservedSplitIndex >= windowStart + WINDOW_SIZE &&
-                windowStart + WINDOW_SIZE < immutableSplits.size()) {
-                windowStart++;
-                rebuildSplitLabels();
+            // Scroll forward: once we've completed splits beyond the window,
+            // advance it so the next upcoming split is always visible at the bottom
+            if (splitView && lastObservedSplitIndex >= splitView->top() + WINDOW_SIZE) {
+                splitView->setTop(splitView->top() + 1);
             }
         }
     }
@@ -1,17 +1,31 @@
 module;
 
+#ifdef _WIN32
 #include <windows.h>
 #include <tlhelp32.h>
+#else
+#include <cstdint>
+#include <fstream>
+#include <algorithm>
+#include <cctype>
+#endif
 // #include <iostream>
 #include <string>
 
 export module GameAddresses;
 
+import ProcessWatcher;
+
+#ifdef _WIN32
+export using GameProcess = HANDLE;
+#else
+using DWORD = uint32_t;
+export using GameProcess = ProcessId; // nothing to open on Linux, memory is read and watched by pid
+#endif
+
 const std::string FAILED_OPEN_PROCESS          = "Failed to open process for memory reading\n";
 const std::string COULD_NOT_RESOLVE_MODULES    = "Could not resolve required module base addresses\n";
 
-struct WindowData { DWORD pid; HWND hwnd; };
-
 export struct GameAddresses_s {
 
     uintptr_t   baseAddr      = NULL;
@@ -20,13 +34,22 @@ export struct GameAddresses_s {
     uintptr_t   xrNetServer   = NULL;
     uintptr_t   xrGame        = NULL;
     uintptr_t   xrCore        = NULL;
-    HANDLE      hProcess      = nullptr;
+    GameProcess hProcess      = {};      // process handle on Windows, pid on Linux
+
+    // module image sizes, needed to scan them for signatures
+    DWORD       xrNetServerSize = 0;
+    DWORD       xrGameSize      = 0;
+    DWORD       xrCoreSize      = 0;
 
     // New: pointer size (in bytes) of the target process (4 for 32-bit, 8 for 64-bit)
     unsigned    ptrSize       = sizeof(void*);
 
 } gameAddresses;
 
+#ifdef _WIN32
+
+struct WindowData { DWORD pid; HWND hwnd; };
+
 static std::wstring toWide(const char* str)
 {
     if (!str) return {};
@@ -166,8 +189,6 @@ DWORD GetProcessIdFromWindow(HWND hwnd) {
 
 export void setupGameAddresses () {
 
-    DWORD dummySize;
-
     HWND hwnd = FindGameWindow("XR_3DA.exe");
 
     if (!hwnd) {
@@ -179,7 +200,7 @@ export void setupGameAddresses () {
 
     DWORD pid = GetProcessIdFromWindow(hwnd);
 
-    gameAddresses.hProcess = OpenProcess(PROCESS_VM_READ | PROCESS_QUERY_INFORMATION, FALSE, pid);
+    gameAddresses.hProcess = OpenProcess(PROCESS_VM_READ | PROCESS_QUERY_INFORMATION | SYNCHRONIZE, FALSE, pid); // SYNCHRONIZE: exit notification
 
     if (!gameAddresses.hProcess) {
 
@@ -204,9 +225,9 @@ export void setupGameAddresses () {
 
 
     GetModuleInfo(pid, "XR_3DA.exe",gameAddresses.baseAddr, gameAddresses.baseSize);
-    GetModuleInfo(pid, "xrNetServer.dll",gameAddresses.xrNetServer,dummySize);
-    GetModuleInfo(pid, "xrGame.dll",gameAddresses.xrGame, dummySize);
-    GetModuleInfo(pid, "xrCore.dll",gameAddresses.xrCore,dummySize);
+    GetModuleInfo(pid, "xrNetServer.dll",gameAddresses.xrNetServer,gameAddresses.xrNetServerSize);
+    GetModuleInfo(pid, "xrGame.dll",gameAddresses.xrGame, gameAddresses.xrGameSize);
+    GetModuleInfo(pid, "xrCore.dll",gameAddresses.xrCore,gameAddresses.xrCoreSize);
 
     if (!gameAddresses.baseAddr || !gameAddresses.xrNetServer ||
         !gameAddresses.xrGame   || !gameAddresses.xrCore) {
@@ -219,10 +240,86 @@ export void setupGameAddresses () {
 
 }
 
+#else
+
+static std::string toLower(std::string s) {
+
+    std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return std::tolower(c); });
+    return s;
+
+}
+
+// Wine/Proton map each PE image from its file, so a module spans every mapping of that file
+bool GetModuleInfo(ProcessId pid, const char* moduleName,
+                   uintptr_t& baseAddr,
+                   DWORD& moduleSize)
+{
+    std::ifstream maps("/proc/" + std::to_string(pid) + "/maps");
+    const std::string wanted = toLower(moduleName);
+
+    uintptr_t lo = UINTPTR_MAX;
+    uintptr_t hi = 0;
+    std::string line;
+
+    // start-end perms offset dev inode path
+    while (std::getline(maps, line)) {
+
+        const size_t slash = line.find_last_of('/');
+        const size_t dash  = line.find('-');
+        if (slash == std::string::npos || dash == std::string::npos) continue;
+        if (toLower(line.substr(slash + 1)) != wanted) continue;
+
+        lo = std::min<uintptr_t>(lo, std::stoull(line.substr(0, dash), nullptr, 16));
+        hi = std::max<uintptr_t>(hi, std::stoull(line.substr(dash + 1), nullptr, 16));
+
+    }
+
+    if (!hi) return false;
+
+    baseAddr   = lo;
+    moduleSize = static_cast<DWORD>(hi - lo);
+    return true;
+
+}
+
+export void setupGameAddresses () {
+
+    const ProcessId pid = findProcessId("XR_3DA.exe");
+    if (!pid) return;
+
+    gameAddresses.hProcess = pid;
+    gameAddresses.ptrSize  = 4; // the game is a 32-bit PE whatever the host
+
+    GetModuleInfo(pid, "XR_3DA.exe",gameAddresses.baseAddr, gameAddresses.baseSize);
+    GetModuleInfo(pid, "xrNetServer.dll",gameAddresses.xrNetServer,gameAddresses.xrNetServerSize);
+    GetModuleInfo(pid, "xrGame.dll",gameAddresses.xrGame, gameAddresses.xrGameSize);
+    GetModuleInfo(pid, "xrCore.dll",gameAddresses.xrCore,gameAddresses.xrCoreSize);
+
+    if (!gameAddresses.baseAddr || !gameAddresses.xrNetServer ||
+        !gameAddresses.xrGame   || !gameAddresses.xrCore) {
+
+        gameAddresses.hProcess = 0;
+
+    }
+
+}
+
+#endif
+
 export bool isGameReady() {
     return gameAddresses.hProcess &&
            gameAddresses.baseAddr &&
            gameAddresses.xrCore &&
            gameAddresses.xrGame &&
            gameAddresses.xrNetServer;
-}
\ No newline at end of file
+}
+
+// Closes the process handle and forgets every address, after the game exited
+export void releaseGameAddresses() {
+
+#ifdef _WIN32
+    if (gameAddresses.hProcess) CloseHandle(gameAddresses.hProcess);
+#endif
+    gameAddresses = GameAddresses_s{};
+
+}
@@ -1,87 +1,199 @@
 module;
 
+#ifdef _WIN32
 #include <windows.h>
+#endif
 #include <vector>
 #include <cstdint>
 #include <cstring>
+#include <memory>
+#include <chrono>
+#include <cstddef>
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <array>
+#include <type_traits>
 
 export module GameMemory;
 
 import GameAddresses;
+import MemorySource;
+import ReadPlanner;
+import SignatureScanner;
+import Instrumentation;
+export import GameSnapshot;
+
+// Backend for the attached game, recreated whenever setupVersionOffsets() finds the process again
+std::unique_ptr<MemorySource> memorySource;
+
+// Per-tick scatter list of the generic read path, built from versionOffsets.plan, and the buffer its ranges land in
+std::vector<unsigned char> planBuffer;
+std::vector<ReadRequest_s> tickReads;
+
+// Bumped whenever the module bases may have moved, so the per-build read paths refill their scatter lists
+uint64_t attachCount = 0;
 
 struct DeepPointer {
     uintptr_t base;
     std::vector<uintptr_t> offsets;
 
+    // Resolution cache. Walking the chain costs one read per level, so the final address is kept
+    // and only re-resolved when the final read fails, the guard changes or revalidateInterval has
+    // passed since the last full walk. The guard is the last pointer the walk dereferenced, the one
+    // to the object holding the bytes: replacing any link of the chain replaces that object, so it
+    // changes with it, where the pointer stored at base practically never does.
+    uintptr_t cachedTarget       = 0;
+    uintptr_t cachedGuard        = 0;
+    uintptr_t cachedGuardAddress = 0;
+    std::chrono::steady_clock::time_point resolvedAt{};
+    std::chrono::steady_clock::duration revalidateInterval = std::chrono::milliseconds(250);
+
+    uint64_t cacheHits    = 0;
+    uint64_t fullResolves = 0;
+
     DeepPointer(uintptr_t b, std::initializer_list<uintptr_t> offs) : base(b), offsets(offs) {}
 
     // Helper: read a pointer-sized value from target process and return it in 'out'.
-    // Uses gameAddresses.ptrSize (set in GameAddresses) to choose 4/8-byte reads.
-    static bool readTargetPtr(HANDLE hProcess, uintptr_t srcAddr, uintptr_t &out) {
+    // Ptr is the target's pointer type, the per-version paths know it at compile time.
+    template <typename Ptr>
+    static bool readTargetPtrAs(MemorySource& source, uintptr_t srcAddr, uintptr_t &out) {
         if (!srcAddr) return false;
-        if (gameAddresses.ptrSize == 8) {
-            uint64_t tmp = 0;
-            if (!ReadProcessMemory(hProcess, reinterpret_cast<LPCVOID>(srcAddr), &tmp, sizeof(tmp), nullptr)) return false;
-            out = static_cast<uintptr_t>(tmp);
-            return true;
-        } else {
-            uint32_t tmp = 0;
-            if (!ReadProcessMemory(hProcess, reinterpret_cast<LPCVOID>(srcAddr), &tmp, sizeof(tmp), nullptr)) return false;
-            out = static_cast<uintptr_t>(tmp);
-            return true;
-        }
+        Ptr tmp = 0;
+        if (!source.read(srcAddr, &tmp, sizeof(tmp))) return false;
+        out = static_cast<uintptr_t>(tmp);
+        return true;
+    }
+
+    // Same, using gameAddresses.ptrSize (set in GameAddresses) to choose 4/8-byte reads.
+    static bool readTargetPtr(MemorySource& source, uintptr_t srcAddr, uintptr_t &out) {
+        return gameAddresses.ptrSize == 8 ? readTargetPtrAs<uint64_t>(source, srcAddr, out)
+                                          : readTargetPtrAs<uint32_t>(source, srcAddr, out);
     }
 
     // dereference current address first, then add offset
-    uintptr_t resolveDerefFirst(HANDLE hProcess) const {
+    // 'guard' receives the last dereferenced value and 'guardAddress' where it was read from
+    template <typename Ptr>
+    uintptr_t resolveDerefFirst(MemorySource& source, uintptr_t* guard = nullptr, uintptr_t* guardAddress = nullptr) const {
         uintptr_t addr = base;
         for (size_t i = 0; i < offsets.size(); ++i) {
             uintptr_t tmp = 0;
-            if (!readTargetPtr(hProcess, addr, tmp)) {
+            if (!readTargetPtrAs<Ptr>(source, addr, tmp)) {
                 return 0;
             }
+            if (guard) *guard = tmp;
+            if (guardAddress) *guardAddress = addr;
             addr = tmp + offsets[i];
         }
         return addr;
     }
 
-    // Read raw bytes at resolved address.
-    bool resolveBytes(HANDLE hProcess, void* out, size_t len) const {
+    // Read raw bytes at resolved address, walking the whole chain. Refreshes the cache.
+    template <typename Ptr>
+    bool resolveBytesAs(MemorySource& source, void* out, size_t len) {
         if (!out || len == 0) return false;
 
-        uintptr_t addr = resolveDerefFirst(hProcess);
+        ++fullResolves;
+        cachedTarget = 0;
 
-            if (ReadProcessMemory(hProcess, reinterpret_cast<LPCVOID>(addr), out, len, nullptr))
-                return true;
+        uintptr_t guard = 0;
+        uintptr_t guardAddress = 0;
+        uintptr_t addr = resolveDerefFirst<Ptr>(source, &guard, &guardAddress);
 
+        if (source.read(addr, out, len)) {
+            remember(addr, guard, guardAddress);
+            return true;
+        }
 
-            uintptr_t ptr = 0;
-            if (readTargetPtr(hProcess, addr, ptr) && ptr) {
-                if (ReadProcessMemory(hProcess, reinterpret_cast<LPCVOID>(ptr), out, len, nullptr))
-                    return true;
-
+        // the bytes are one more pointer away, which then is the last link
+        uintptr_t ptr = 0;
+        if (readTargetPtrAs<Ptr>(source, addr, ptr) && ptr) {
+            if (source.read(ptr, out, len)) {
+                remember(ptr, ptr, addr);
+                return true;
             }
+        }
 
         return false;
     }
-};
 
-// Snapshot of memory state
-export struct GameMemorySnapshot_s {
-    bool    loading     = false;
-    bool    prompt      = false;
-    unsigned char focusState = 0; // CurMap Workaround: 1 = focused and ingame, 2 = focused and main menu or mapchange trigger or cutscene
-    bool    isPaused    = false;
-    float   sync        = 0.0f;
-    float   globalTimer = 0.0f;
-    // char    CurMap[21]  = {0};
-    char    End[6]      = {0};
-    char    EndRaw[6]   = {0}; // raw bytes before sanitization
+    bool resolveBytes(MemorySource& source, void* out, size_t len) {
+        return gameAddresses.ptrSize == 8 ? resolveBytesAs<uint64_t>(source, out, len)
+                                          : resolveBytesAs<uint32_t>(source, out, len);
+    }
+
+    bool isCacheFresh(std::chrono::steady_clock::time_point now) const {
+        return cachedTarget && now - resolvedAt < revalidateInterval;
+    }
 
+    void invalidate() { cachedTarget = 0; }
+
+private:
+    void remember(uintptr_t target, uintptr_t guard, uintptr_t guardAddress) {
+        cachedTarget       = target;
+        cachedGuard        = guard;
+        cachedGuardAddress = guardAddress;
+        resolvedAt         = std::chrono::steady_clock::now();
+    }
 };
 
 export GameMemorySnapshot_s snapShotCurrent;
-export GameMemorySnapshot_s snapShotPrevious;
+
+
+// Which module a layout offset is relative to
+enum GameModule : uint8_t { MODULE_XR_3DA, MODULE_XR_NET_SERVER, MODULE_XR_GAME };
+
+struct FieldLocation_s {
+    GameModule  module;
+    uintptr_t   offset;
+};
+
+// A known game build, described entirely at compile time
+export struct GameLayout_s {
+    unsigned        ptrSize;
+
+    FieldLocation_s loading;
+    FieldLocation_s prompt;
+    FieldLocation_s focusState;
+    FieldLocation_s isPaused;
+    FieldLocation_s sync;
+    FieldLocation_s globalTimer;
+
+    uintptr_t                   endBase;    // relative to XR_3DA.exe
+    std::array<uintptr_t, 7>    endOffsets;
+
+    float syncLowerBound;
+    float syncUpperBound;
+};
+
+export constexpr GameLayout_s layout10000 = {
+    4,
+    { MODULE_XR_NET_SERVER, 0xFAC4   },
+    { MODULE_XR_GAME,       0x54C2F9 },
+    { MODULE_XR_3DA,        0x10300C },
+    { MODULE_XR_3DA,        0x1047C0 },
+    { MODULE_XR_3DA,        0x104928 },
+    { MODULE_XR_3DA,        0x10492C },
+    // CurMap: xrCore + 0xBA040, {0x4,0x0,0x40,0x8,0x20,0x14}
+    0x1048BC, {0x54,0x14,0x0,0x0,0x44,0xC,0x12},
+    0.057f, 0.11f,
+};
+
+export constexpr GameLayout_s layout10006 = {
+    4,
+    { MODULE_XR_NET_SERVER, 0x13E84  },
+    { MODULE_XR_GAME,       0x560668 },
+    { MODULE_XR_3DA,        0x10A10C },
+    { MODULE_XR_3DA,        0x10BCD0 },
+    { MODULE_XR_3DA,        0x10BE80 },
+    { MODULE_XR_3DA,        0x10BE84 },
+    // CurMap: xrCore + 0xBF368, {0x4,0x0,0x40,0x8,0x28,0x4}
+    0x10BDB0, {0x3C,0x10,0x0,0x0,0x44,0xC,0x12},
+    0.09f, 0.11f,
+};
+
+// Which read path the worker should run for the attached build
+export enum GameVersion : uint8_t { GAME_VERSION_1_0000, GAME_VERSION_1_0006, GAME_VERSION_SCANNED };
 
 
 // Offsets for the current game version
@@ -95,82 +207,260 @@ export struct VersionOffsets_s {
     // DeepPointer CurMap      = DeepPointer(gameAddresses.xrCore   + 0x0, {0x0,0x0,0x0,0x0,0x0,0x0});
     DeepPointer End         = DeepPointer(gameAddresses.baseAddr + 0x0, {0x0,0x0,0x0,0x0,0x0,0x0,0x0});
 
-    // Bulk-read block for tightly packed timer-related fields
-    uintptr_t blockBase     = 0x0;
-    size_t    blockSize     = 0;
-    size_t    offFocusState = 0;
-    size_t    offIsPaused   = 0;
-    size_t    offSync       = 0;
-    size_t    offGlobal     = 0;
+    // Coalesced reads for all plain fields, rebuilt per version by setupVersionOffsets()
+    ReadPlan_s plan;
 
-    // Maximum bulk block size (covers both supported versions)
-    static constexpr size_t kMaxBulkBlock = 0x2000;
+    // The old loading/prompt/single-block layout and its estimated cost, for comparison
+    std::vector<PlannedRange_s> fixedBlock;
+    double                      fixedBlockCostNs = 0.0;
 
     float syncLowerBound    = 0.0f;
     float syncUpperBound    = 0.0f;
 
+    GameVersion version     = GAME_VERSION_1_0006;
+
 } versionOffsets;
 
+inline uintptr_t moduleBase(GameModule module) {
+    switch (module) {
+        case MODULE_XR_NET_SERVER:  return gameAddresses.xrNetServer;
+        case MODULE_XR_GAME:        return gameAddresses.xrGame;
+        default:                    return gameAddresses.baseAddr;
+    }
+}
+
+// The plain fields read every tick, at the given addresses
+constexpr std::vector<WatchedField_s> snapshotFields(uintptr_t loading, uintptr_t prompt, uintptr_t focusState,
+                                                     uintptr_t isPaused, uintptr_t sync, uintptr_t globalTimer) {
+    return {
+        { loading,     sizeof(GameMemorySnapshot_s::loading),     offsetof(GameMemorySnapshot_s, loading)     },
+        { prompt,      sizeof(GameMemorySnapshot_s::prompt),      offsetof(GameMemorySnapshot_s, prompt)      },
+        { focusState,  sizeof(GameMemorySnapshot_s::focusState),  offsetof(GameMemorySnapshot_s, focusState)  },
+        { isPaused,    sizeof(GameMemorySnapshot_s::isPaused),    offsetof(GameMemorySnapshot_s, isPaused)    },
+        { sync,        sizeof(GameMemorySnapshot_s::sync),        offsetof(GameMemorySnapshot_s, sync)        },
+        { globalTimer, sizeof(GameMemorySnapshot_s::globalTimer), offsetof(GameMemorySnapshot_s, globalTimer) },
+    };
+}
+
+// A known build's field reads, planned by the compiler against the process backend's cost model.
+// The planner sees module-relative offsets on a made up address space where every module starts a
+// kModuleSpacing apart, so no range can span two modules, and each range is turned back into a
+// module and an offset for the read path to add the module's base to.
+constexpr uintptr_t kModuleSpacing = uintptr_t{1} << 28;
+
+struct LayoutRange_s {
+    GameModule  module;
+    uintptr_t   offset;
+    size_t      length;
+    size_t      bufferOffset;
+};
+
+template <size_t RangeCount, size_t FieldCount>
+struct LayoutPlan_s {
+    std::array<LayoutRange_s, RangeCount>   ranges;
+    std::array<FieldSlice_s, FieldCount>    slices;
+    size_t                                  bufferSize;
+};
+
+constexpr ReadPlan_s planLayoutReads(const GameLayout_s& layout) {
+
+    auto at = [](const FieldLocation_s& f) { return (static_cast<uintptr_t>(f.module) + 1) * kModuleSpacing + f.offset; };
+
+    return planReads(snapshotFields(at(layout.loading), at(layout.prompt), at(layout.focusState),
+                                    at(layout.isPaused), at(layout.sync), at(layout.globalTimer)), kProcessReadCostModel);
+
+}
+
+template <const GameLayout_s& Layout>
+consteval auto makeLayoutPlan() {
+
+    static_assert(std::max({ Layout.loading.offset, Layout.prompt.offset, Layout.focusState.offset,
+                             Layout.isPaused.offset, Layout.sync.offset, Layout.globalTimer.offset }) < kModuleSpacing / 2);
+
+    constexpr size_t rangeCount = planLayoutReads(Layout).ranges.size();
+    constexpr size_t fieldCount = planLayoutReads(Layout).slices.size();
+    const ReadPlan_s plan = planLayoutReads(Layout);
+
+    LayoutPlan_s<rangeCount, fieldCount> out{};
+    for (size_t i = 0; i < rangeCount; ++i) {
+        const PlannedRange_s& r = plan.ranges[i];
+        out.ranges[i] = { static_cast<GameModule>(r.address / kModuleSpacing - 1), r.address % kModuleSpacing, r.length, r.bufferOffset };
+    }
+    for (size_t i = 0; i < fieldCount; ++i) out.slices[i] = plan.slices[i];
+    out.bufferSize = plan.bufferSize;
+    return out;
+
+}
+
+template <const GameLayout_s& Layout>
+constexpr auto layoutPlan = makeLayoutPlan<Layout>();
+
+static void applyLayout(const GameLayout_s& layout, GameVersion version) {
+
+    auto at = [](const FieldLocation_s& f) { return moduleBase(f.module) + f.offset; };
+
+    versionOffsets.loading      = at(layout.loading);
+    versionOffsets.prompt       = at(layout.prompt);
+    versionOffsets.focusState   = at(layout.focusState);
+    versionOffsets.isPaused     = at(layout.isPaused);
+    versionOffsets.sync         = at(layout.sync);
+    versionOffsets.globalTimer  = at(layout.globalTimer);
+
+    versionOffsets.End = DeepPointer(gameAddresses.baseAddr + layout.endBase, {});
+    versionOffsets.End.offsets.assign(layout.endOffsets.begin(), layout.endOffsets.end());
+
+    versionOffsets.syncLowerBound = layout.syncLowerBound;
+    versionOffsets.syncUpperBound = layout.syncUpperBound;
+    versionOffsets.version        = version;
+
+}
+
+
+// Any build other than 1.0000: locate the fields with the user supplied signatures in Signatures.txt.
+// Fails (and the caller falls back to the 1.0006 table) unless every field resolves unambiguously.
+// 1.0006's image size isn't known the way 1.0000's is, so it is told apart here, by where its fields are.
+static bool applyScannedOffsets() {
+
+    if (!memorySource) return false;
+
+    const std::vector<Signature_s> signatures = loadSignatures("Signatures.txt");
+    if (signatures.empty()) return false;
+
+    const std::vector<ScanModule_s> modules = {
+        { "XR_3DA.exe",      gameAddresses.baseAddr,    gameAddresses.baseSize        },
+        { "xrNetServer.dll", gameAddresses.xrNetServer, gameAddresses.xrNetServerSize },
+        { "xrGame.dll",      gameAddresses.xrGame,      gameAddresses.xrGameSize      },
+    };
+    const FieldOffsets found = scanSignatures(*memorySource, modules, signatures, "Signatures.cache");
+
+    // offsets are relative to the module named in the field's signature, which needn't be the one the
+    // field lives in on 1.0006
+    std::unordered_map<std::string, uintptr_t> fieldBase;
+    for (const Signature_s& sig : signatures) {
+        for (const ScanModule_s& mod : modules) {
+            if (mod.name == sig.module) fieldBase[sig.field] = mod.base;
+        }
+    }
+
+    for (const char* field : { "loading", "prompt", "focusState", "isPaused", "sync", "globalTimer", "End" }) {
+        if (!found.count(field) || !fieldBase.count(field)) return false;
+    }
+    auto address = [&](const char* field) { return fieldBase.at(field) + found.at(field); };
+    auto at10006 = [&](const char* field, const FieldLocation_s& location) {
+        return address(field) == moduleBase(location.module) + location.offset;
+    };
+
+    // 1.0006 itself, whose signatures match too: most fields land on its table, and any that don't come
+    // from a bad signature. It keeps its known offsets and the read path planned for it at compile time.
+    const int matching10006 = at10006("loading",     layout10006.loading)     +
+                              at10006("prompt",      layout10006.prompt)      +
+                              at10006("focusState",  layout10006.focusState)  +
+                              at10006("isPaused",    layout10006.isPaused)    +
+                              at10006("sync",        layout10006.sync)        +
+                              at10006("globalTimer", layout10006.globalTimer) +
+                              (address("End") == gameAddresses.baseAddr + layout10006.endBase);
+    if (matching10006 > 7 / 2) {
+        applyLayout(layout10006, GAME_VERSION_1_0006);
+        return true;
+    }
+
+    versionOffsets.loading      = address("loading");
+    versionOffsets.prompt       = address("prompt");
+    versionOffsets.focusState   = address("focusState");
+    versionOffsets.isPaused     = address("isPaused");
+    versionOffsets.sync         = address("sync");
+    versionOffsets.globalTimer  = address("globalTimer");
+    // only the chain base moves between builds, the object layout behind it is the 1.0006 one
+    versionOffsets.End          = DeepPointer(address("End"), {});
+    versionOffsets.End.offsets.assign(layout10006.endOffsets.begin(), layout10006.endOffsets.end());
+
+    versionOffsets.syncLowerBound = layout10006.syncLowerBound;
+    versionOffsets.syncUpperBound = layout10006.syncUpperBound;
+    versionOffsets.version        = GAME_VERSION_SCANNED;
+
+    return true;
+
+}
+
+// Plans the plain field reads for the offsets in versionOffsets, with the attached backend's cost model
+static void planVersionReads() {
+
+    const ReadCostModel_s model = memorySource ? memorySource->costModel() : ReadCostModel_s{};
+
+    versionOffsets.plan = planReads(snapshotFields(versionOffsets.loading, versionOffsets.prompt, versionOffsets.focusState,
+                                                   versionOffsets.isPaused, versionOffsets.sync, versionOffsets.globalTimer), model);
+
+    const uintptr_t blockBegin = std::min({ versionOffsets.focusState, versionOffsets.isPaused,
+                                            versionOffsets.sync, versionOffsets.globalTimer });
+    const uintptr_t blockEnd   = std::max({ versionOffsets.focusState  + sizeof(snapShotCurrent.focusState),
+                                            versionOffsets.isPaused    + sizeof(snapShotCurrent.isPaused),
+                                            versionOffsets.sync        + sizeof(snapShotCurrent.sync),
+                                            versionOffsets.globalTimer + sizeof(snapShotCurrent.globalTimer) });
+
+    versionOffsets.fixedBlock = {
+        { versionOffsets.loading, sizeof(snapShotCurrent.loading), 0 },
+        { versionOffsets.prompt,  sizeof(snapShotCurrent.prompt),  0 },
+        { blockBegin, static_cast<size_t>(blockEnd - blockBegin),  0 },
+    };
+    versionOffsets.fixedBlockCostNs = estimateReadCost(versionOffsets.fixedBlock, model);
+
+    planBuffer.assign(versionOffsets.plan.bufferSize, 0);
+    ++attachCount;
+
+    // room for the End chain's two reads after the ranges
+    tickReads.clear();
+    for (const auto& r : versionOffsets.plan.ranges) {
+        tickReads.push_back({ r.address, r.length, planBuffer.data() + r.bufferOffset });
+    }
+    tickReads.resize(tickReads.size() + 2);
+
+}
 
 export void setupVersionOffsets() {
 
     setupGameAddresses();
 
+    memorySource.reset();
+    if (isGameReady()) memorySource = makeProcessMemorySource(gameAddresses.hProcess);
 
     if (gameAddresses.baseSize == 1662976 || gameAddresses.baseSize == 1613824) {
-        // 1.0000
-        versionOffsets.loading      = gameAddresses.xrNetServer + 0xFAC4;
-        versionOffsets.prompt       = gameAddresses.xrGame      + 0x54C2F9;
-        versionOffsets.focusState   = gameAddresses.baseAddr    + 0x10300C;
-        versionOffsets.isPaused     = gameAddresses.baseAddr    + 0x1047C0;
-        versionOffsets.sync         = gameAddresses.baseAddr    + 0x104928;
-        versionOffsets.globalTimer  = gameAddresses.baseAddr    + 0x10492C;
-        // versionOffsets.CurMap       = DeepPointer(gameAddresses.xrCore + 0xBA040, {0x4,0x0,0x40,0x8,0x20,0x14});
-        versionOffsets.End          = DeepPointer(gameAddresses.baseAddr + 0x1048BC, {0x54,0x14,0x0,0x0,0x44,0xC,0x12});
-
-        versionOffsets.syncLowerBound = 0.057f;
-        versionOffsets.syncUpperBound = 0.11f;
+
+        applyLayout(layout10000, GAME_VERSION_1_0000);
+
+    } else if (isGameReady() && applyScannedOffsets()) {
+
+        // offsets came from Signatures.txt
 
     } else {
-         // 1.0006
-        versionOffsets.loading      = gameAddresses.xrNetServer + 0x13E84;
-        versionOffsets.prompt       = gameAddresses.xrGame      + 0x560668;
-        versionOffsets.focusState   = gameAddresses.baseAddr    + 0x10A10C;
-        versionOffsets.isPaused     = gameAddresses.baseAddr    + 0x10BCD0;
-        versionOffsets.sync         = gameAddresses.baseAddr    + 0x10BE80;
-        versionOffsets.globalTimer  = gameAddresses.baseAddr    + 0x10BE84;
-        // versionOffsets.CurMap       = DeepPointer(gameAddresses.xrCore + 0xBF368, {0x4,0x0,0x40,0x8,0x28,0x4});
-        versionOffsets.End          = DeepPointer(gameAddresses.baseAddr + 0x10BDB0, {0x3C,0x10,0x0,0x0,0x44,0xC,0x12});
 
-        versionOffsets.syncLowerBound = 0.09f;
-        versionOffsets.syncUpperBound = 0.11f;
+        applyLayout(layout10006, GAME_VERSION_1_0006);
 
     }
 
-    // Compute bulk-read block (covers focusState/isPaused/sync/globalTimer)
-    {
-        const uintptr_t a1 = versionOffsets.focusState;
-        const uintptr_t a2 = versionOffsets.isPaused;
-        const uintptr_t a3 = versionOffsets.sync;
-        const uintptr_t a4 = versionOffsets.globalTimer;
+    planVersionReads();
+
+}
 
-        const uintptr_t minAddr = std::min(std::min(a1, a2), std::min(a3, a4));
-        const uintptr_t maxEnd =
-            std::max(std::max(a1 + sizeof(snapShotCurrent.focusState),
-                              a2 + sizeof(snapShotCurrent.isPaused)),
-                     std::max(a3 + sizeof(snapShotCurrent.sync),
-                              a4 + sizeof(snapShotCurrent.globalTimer)));
+// Attaches to 'source' as a known build, taking the module bases already in gameAddresses as they are.
+// The read benchmarks use it to point the read paths at a stand-in for the game.
+export void attachLayout(std::unique_ptr<MemorySource> source, const GameLayout_s& layout, GameVersion version) {
+
+    memorySource = std::move(source);
+    applyLayout(layout, version);
+    planVersionReads();
+
+}
+
+// Drops the backend and every cached address once the game is gone, so nothing keeps its handle open
+export void detachGame() {
+
+    memorySource.reset();
+    versionOffsets.End.invalidate();
+    releaseGameAddresses();
 
-        versionOffsets.blockBase     = minAddr;
-        versionOffsets.blockSize     = static_cast<size_t>(maxEnd - minAddr);
-        versionOffsets.offFocusState = static_cast<size_t>(a1 - minAddr);
-        versionOffsets.offIsPaused   = static_cast<size_t>(a2 - minAddr);
-        versionOffsets.offSync       = static_cast<size_t>(a3 - minAddr);
-        versionOffsets.offGlobal     = static_cast<size_t>(a4 - minAddr);
-    }
 }
 
-static bool isPrintableAscii(const char* s, size_t maxlen) {
+inline bool isPrintableAscii(const char* s, size_t maxlen) {
     if (!s || maxlen == 0) return false;
     size_t len = 0;
     for (; len < maxlen && s[len] != '\0'; ++len) {
@@ -180,51 +470,62 @@ static bool isPrintableAscii(const char* s, size_t maxlen) {
     return len > 0;
 }
 
-export void readGameMemorySnapshot() {
+// One tick worth of reads. 'reads' starts with the planned field ranges, 'planReadCount' of them,
+// landing in 'buffer', and has room for two more; 'slices' says where each field's bytes are.
+// Ptr is the target's pointer type, fixed per instantiation so nothing in here has to look at the
+// game version or pointer width.
+template <typename Ptr, typename Slices>
+inline void readTick(ReadRequest_s* reads, size_t planReadCount, const Slices& slices, const unsigned char* buffer) {
+
+    DeepPointer& end = versionOffsets.End;
+    char raw[5] = {0};
+    Ptr endGuard = 0;
+
+    // The planned field ranges and, while the End chain is cached, its last link and final read
+    // all go out as one scatter read
+    size_t readCount = planReadCount;
+
+    const bool endCached = end.isCacheFresh(std::chrono::steady_clock::now());
+    if (endCached) {
+        reads[readCount++] = { end.cachedGuardAddress, sizeof(Ptr), &endGuard };
+        reads[readCount++] = { end.cachedTarget, sizeof(raw), raw };
+    }
 
-    ReadProcessMemory(gameAddresses.hProcess, reinterpret_cast<LPCVOID>(versionOffsets.loading),
-        &snapShotCurrent.loading, sizeof(snapShotCurrent.loading), nullptr);
+    {
+        StageTimer timer(STAGE_FIELD_READS);
+        memorySource->readScatter(reads, readCount);
+    }
 
-    ReadProcessMemory(gameAddresses.hProcess, reinterpret_cast<LPCVOID>(versionOffsets.prompt),
-        &snapShotCurrent.prompt, sizeof(snapShotCurrent.prompt), nullptr);
+    for (size_t i = 0; i < planReadCount; ++i) {
+        if (!reads[i].ok) countEvent(COUNTER_FAILED_READS);
+    }
 
-    // Bulk read focusState/isPaused/sync/globalTimer in one RPM call
-    {
-        static thread_local unsigned char block[VersionOffsets_s::kMaxBulkBlock];
-        if (versionOffsets.blockBase &&
-            versionOffsets.blockSize > 0 &&
-            versionOffsets.blockSize <= VersionOffsets_s::kMaxBulkBlock &&
-            ReadProcessMemory(gameAddresses.hProcess,
-                              reinterpret_cast<LPCVOID>(versionOffsets.blockBase),
-                              block,
-                              versionOffsets.blockSize,
-                              nullptr)) {
-
-            std::memcpy(&snapShotCurrent.focusState,
-                        block + versionOffsets.offFocusState,
-                        sizeof(snapShotCurrent.focusState));
-
-            std::memcpy(&snapShotCurrent.isPaused,
-                        block + versionOffsets.offIsPaused,
-                        sizeof(snapShotCurrent.isPaused));
-
-            std::memcpy(&snapShotCurrent.sync,
-                        block + versionOffsets.offSync,
-                        sizeof(snapShotCurrent.sync));
-
-            std::memcpy(&snapShotCurrent.globalTimer,
-                        block + versionOffsets.offGlobal,
-                        sizeof(snapShotCurrent.globalTimer));
+    auto* snapshotBytes = reinterpret_cast<unsigned char*>(&snapShotCurrent);
+    for (const auto& slice : slices) {
+        if (reads[slice.rangeIndex].ok) {
+            std::memcpy(snapshotBytes + slice.snapshotOffset, buffer + slice.bufferOffset, slice.size);
         }
     }
 
     // End - always capture raw 5 bytes, but suppress verbose debug unless requested
     {
-        char raw[5] = {0};
         bool gotRaw = false;
 
-        if (versionOffsets.End.resolveBytes(gameAddresses.hProcess, raw, sizeof(raw))) {
+        if (endCached && reads[planReadCount].ok && reads[planReadCount + 1].ok &&
+            static_cast<uintptr_t>(endGuard) == end.cachedGuard) {
+
+            ++end.cacheHits;
             gotRaw = true;
+
+        } else {
+
+            // stale, failed or expired: walk the chain again
+            StageTimer timer(STAGE_END_RESOLVE);
+            end.invalidate();
+            std::memset(raw, 0, sizeof(raw));
+            gotRaw = end.resolveBytesAs<Ptr>(*memorySource, raw, sizeof(raw));
+            if (!gotRaw) countEvent(COUNTER_FAILED_END_RESOLVES);
+
         }
 
         // Always update EndRaw buffer (NUL-terminate for safe logging)
@@ -248,3 +549,57 @@ export void readGameMemorySnapshot() {
     }
 
 }
+
+// Read path for a known build, picked once at attach (see versionOffsets.version). How many ranges,
+// their module offsets and sizes and where each field lands are constants here; the addresses are
+// the module bases plus those offsets, filled into the scatter list once per attach. The pointer
+// width comes from the layout.
+export template <const GameLayout_s& Layout>
+void readGameMemorySnapshotFor() {
+
+    if (!memorySource) return;
+
+    constexpr auto& plan = layoutPlan<Layout>;
+    using Ptr = std::conditional_t<Layout.ptrSize == 8, uint64_t, uint32_t>;
+
+    static unsigned char buffer[plan.bufferSize];
+    static ReadRequest_s reads[plan.ranges.size() + 2];
+    static uint64_t      readsAttach = 0;
+
+    if (readsAttach != attachCount) {
+        for (size_t i = 0; i < plan.ranges.size(); ++i) {
+            const LayoutRange_s& r = plan.ranges[i];
+            reads[i] = { moduleBase(r.module) + r.offset, r.length, buffer + r.bufferOffset };
+        }
+        readsAttach = attachCount;
+    }
+
+    readTick<Ptr>(reads, plan.ranges.size(), plan.slices, buffer);
+
+}
+
+// Generic read path for scanned offsets: the plan made at attach, pointer width decided per call
+export void readGameMemorySnapshot() {
+
+    if (!memorySource) return;
+
+    const size_t planReadCount = versionOffsets.plan.ranges.size();
+    if (gameAddresses.ptrSize == 8) readTick<uint64_t>(tickReads.data(), planReadCount, versionOffsets.plan.slices, planBuffer.data());
+    else readTick<uint32_t>(tickReads.data(), planReadCount, versionOffsets.plan.slices, planBuffer.data());
+
+}
+
+// OS read calls issued against the game so far (0 while detached)
+export uint64_t memoryReadSyscalls() {
+    return memorySource ? memorySource->syscallCount() : 0;
+}
+
+export struct PointerCacheStats_s {
+    uint64_t cacheHits    = 0;
+    uint64_t fullResolves = 0;
+};
+
+// End chain: ticks served from the cached address vs. full walks of the chain (worker thread only)
+export PointerCacheStats_s endPointerStats() {
+    return { versionOffsets.End.cacheHits, versionOffsets.End.fullResolves };
+}
@@ -0,0 +1,52 @@
+module;
+
+#include <cstdint>
+#include <cstring>
+
+export module GameSnapshot;
+
+// Snapshot of memory state
+// Kept free of any OS headers so traces can be written, read and replayed on every platform
+export struct GameMemorySnapshot_s {
+    bool    loading     = false;
+    bool    prompt      = false;
+    unsigned char focusState = 0; // CurMap Workaround: 1 = focused and ingame, 2 = focused and main menu or mapchange trigger or cutscene
+    bool    isPaused    = false;
+    float   sync        = 0.0f;
+    float   globalTimer = 0.0f;
+    // char    CurMap[21]  = {0};
+    char    End[6]      = {0};
+    char    EndRaw[6]   = {0}; // raw bytes before sanitization
+
+};
+
+// One bit per snapshot field, set when the field's bytes differ between two snapshots
+export enum SnapshotField : uint16_t {
+
+    FIELD_LOADING       = 1 << 0,
+    FIELD_PROMPT        = 1 << 1,
+    FIELD_FOCUS_STATE   = 1 << 2,
+    FIELD_IS_PAUSED     = 1 << 3,
+    FIELD_SYNC          = 1 << 4,
+    FIELD_GLOBAL_TIMER  = 1 << 5,
+    FIELD_END           = 1 << 6,
+
+};
+
+export uint16_t diffSnapshots(const GameMemorySnapshot_s& a, const GameMemorySnapshot_s& b) {
+
+    // steady state: one memcmp and done
+    if (std::memcmp(&a, &b, sizeof(GameMemorySnapshot_s)) == 0) return 0;
+
+    uint16_t changed = 0;
+    if (a.loading    != b.loading)                                     changed |= FIELD_LOADING;
+    if (a.prompt     != b.prompt)                                      changed |= FIELD_PROMPT;
+    if (a.focusState != b.focusState)                                  changed |= FIELD_FOCUS_STATE;
+    if (a.isPaused   != b.isPaused)                                    changed |= FIELD_IS_PAUSED;
+    if (std::memcmp(&a.sync, &b.sync, sizeof(a.sync)) != 0)            changed |= FIELD_SYNC;
+    if (std::memcmp(&a.globalTimer, &b.globalTimer, sizeof(a.globalTimer)) != 0) changed |= FIELD_GLOBAL_TIMER;
+    if (std::memcmp(a.EndRaw, b.EndRaw, sizeof(a.EndRaw)) != 0 ||
+        std::memcmp(a.End, b.End, sizeof(a.End)) != 0)                changed |= FIELD_END;
+    return changed;
+
+}
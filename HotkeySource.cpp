@@ -0,0 +1,408 @@
+module;
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <linux/input.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <ctime>
+#include <filesystem>
+#include <vector>
+#endif
+#include <cstdint>
+#include <chrono>
+#include <thread>
+#include <future>
+#include <memory>
+#include <string>
+#include <atomic>
+
+export module HotkeySource;
+
+import TimerEngine;
+import SpscQueue;
+import PerfTracer;
+
+// One press of a bound key: which TimerInput it maps to and when the OS saw it, on the
+// steady_clock time line the worker and the traces use
+export struct KeyEvent_s {
+
+    uint8_t input       = 0;
+    int64_t timestampNs = 0;
+
+};
+
+// Virtual-key codes (Settings' KEY_MAP) of the four timer keys
+export struct HotkeyBindings_s {
+
+    unsigned reset      = 0;
+    unsigned startSplit = 0;
+    unsigned skip       = 0;
+    unsigned undo       = 0;
+
+};
+
+// Delivers timer key presses as they happen. A backend thread blocks on the OS input source and
+// pushes into a ring; the worker only drains that ring, so an idle tick makes no input calls at all.
+export class HotkeySource {
+
+public:
+
+    virtual ~HotkeySource() = default;
+
+    virtual bool start(const HotkeyBindings_s& bindings) = 0;
+    virtual void stop() = 0;
+
+    // worker thread only
+    bool poll(KeyEvent_s& out) { return events.pop(out); }
+
+protected:
+
+    // backend thread only
+    void deliver(unsigned key, int64_t timestampNs) {
+
+        uint8_t input = 0;
+        if (key == keys.reset)      input |= INPUT_RESET;
+        if (key == keys.startSplit) input |= INPUT_START_SPLIT;
+        if (key == keys.skip)       input |= INPUT_SKIP;
+        if (key == keys.undo)       input |= INPUT_UNDO;
+        if (!input) return;
+
+        events.push({ input, timestampNs });
+        perfInstant("key", timestampNs, input);
+
+    }
+
+    bool isBound(unsigned key) const {
+        return key == keys.reset || key == keys.startSplit || key == keys.skip || key == keys.undo;
+    }
+
+    HotkeyBindings_s keys;
+
+private:
+
+    SpscQueue<KeyEvent_s, 64> events;
+
+};
+
+#ifdef _WIN32
+
+static int64_t steadyNowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Windows: low-level keyboard (and, if a mouse button is bound, mouse) hooks on a thread of their own.
+// The hook runs inside the input delivery path, so its clock reading is taken right at the press;
+// 'time' in the hook struct only corrects for delivery that was held up.
+class WindowsHotkeySource final : public HotkeySource {
+
+public:
+
+    ~WindowsHotkeySource() override { stop(); }
+
+    bool start(const HotkeyBindings_s& bindings) override {
+
+        stop();
+        keys = bindings;
+        active = this;
+
+        std::promise<bool> installed;
+        auto ready = installed.get_future();
+        hookThread = std::thread([this, &installed] { run(installed); });
+
+        if (ready.get()) return true;
+        hookThread.join();
+        active = nullptr;
+        return false;
+
+    }
+
+    void stop() override {
+
+        if (!hookThread.joinable()) return;
+        PostThreadMessageW(threadId, WM_QUIT, 0, 0);
+        hookThread.join();
+        active = nullptr;
+
+    }
+
+private:
+
+    void run(std::promise<bool>& installed) {
+
+        threadId = GetCurrentThreadId();
+        setPerfThreadName("hotkeys");
+        SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_HIGHEST); // a slow LL hook gets removed silently
+
+        MSG msg;
+        PeekMessageW(&msg, nullptr, WM_USER, WM_USER, PM_NOREMOVE); // create the queue for PostThreadMessage
+
+        HHOOK keyboardHook = SetWindowsHookExW(WH_KEYBOARD_LL, keyboardProc, GetModuleHandleW(nullptr), 0);
+        HHOOK mouseHook = nullptr;
+        if (keyboardHook && bindsMouse()) mouseHook = SetWindowsHookExW(WH_MOUSE_LL, mouseProc, GetModuleHandleW(nullptr), 0);
+
+        installed.set_value(keyboardHook != nullptr);
+        if (!keyboardHook) return;
+
+        while (GetMessageW(&msg, nullptr, 0, 0) > 0) {}
+
+        if (mouseHook) UnhookWindowsHookEx(mouseHook);
+        UnhookWindowsHookEx(keyboardHook);
+
+    }
+
+    bool bindsMouse() const {
+
+        for (unsigned vk : { VK_LBUTTON, VK_RBUTTON, VK_MBUTTON, VK_XBUTTON1, VK_XBUTTON2 }) {
+            if (isBound(vk)) return true;
+        }
+        return false;
+
+    }
+
+    // GetTickCount and the hook's time both move in timer ticks (~15.6 ms), so an age under two of
+    // them is rounding, not delay. Only a hook that was held up that long is dated back.
+    static constexpr DWORD kTickSlackMs = 32;
+
+    static int64_t pressTime(DWORD eventTickMs) {
+
+        const int64_t now = steadyNowNs();
+        const DWORD age = GetTickCount() - eventTickMs;
+        return age > kTickSlackMs && age < 1000 ? now - static_cast<int64_t>(age) * 1'000'000 : now;
+
+    }
+
+    // LL hooks deliver key repeat as more key downs, only the first one counts
+    void press(unsigned vk, DWORD eventTickMs) {
+
+        if (vk >= 256 || down[vk]) return;
+        down[vk] = true;
+        deliver(vk, pressTime(eventTickMs));
+
+    }
+
+    void release(unsigned vk) { if (vk < 256) down[vk] = false; }
+
+    static LRESULT CALLBACK keyboardProc(int code, WPARAM wParam, LPARAM lParam) {
+
+        if (code == HC_ACTION && active) {
+
+            const auto* kb = reinterpret_cast<const KBDLLHOOKSTRUCT*>(lParam);
+            if (wParam == WM_KEYDOWN || wParam == WM_SYSKEYDOWN) active->press(kb->vkCode, kb->time);
+            else if (wParam == WM_KEYUP || wParam == WM_SYSKEYUP) active->release(kb->vkCode);
+
+        }
+        return CallNextHookEx(nullptr, code, wParam, lParam);
+
+    }
+
+    static LRESULT CALLBACK mouseProc(int code, WPARAM wParam, LPARAM lParam) {
+
+        if (code == HC_ACTION && active) {
+
+            const auto* ms = reinterpret_cast<const MSLLHOOKSTRUCT*>(lParam);
+            const unsigned xButton = HIWORD(ms->mouseData) == XBUTTON1 ? VK_XBUTTON1 : VK_XBUTTON2;
+
+            switch (wParam) {
+                case WM_LBUTTONDOWN:    active->press(VK_LBUTTON, ms->time);    break;
+                case WM_RBUTTONDOWN:    active->press(VK_RBUTTON, ms->time);    break;
+                case WM_MBUTTONDOWN:    active->press(VK_MBUTTON, ms->time);    break;
+                case WM_XBUTTONDOWN:    active->press(xButton, ms->time);       break;
+                case WM_LBUTTONUP:      active->release(VK_LBUTTON);            break;
+                case WM_RBUTTONUP:      active->release(VK_RBUTTON);            break;
+                case WM_MBUTTONUP:      active->release(VK_MBUTTON);            break;
+                case WM_XBUTTONUP:      active->release(xButton);               break;
+                default: break;
+            }
+
+        }
+        return CallNextHookEx(nullptr, code, wParam, lParam);
+
+    }
+
+    // LL hook procs get no user pointer, there is only ever one source
+    static inline WindowsHotkeySource* active = nullptr;
+
+    std::thread         hookThread;
+    std::atomic<DWORD>  threadId{0};
+    bool                down[256] = {};
+
+};
+
+export std::unique_ptr<HotkeySource> makeHotkeySource() {
+    return std::make_unique<WindowsHotkeySource>();
+}
+
+#else
+
+// Virtual-key code (what Settings stores) to evdev key code, 0 if there is no equivalent
+export unsigned vkToEvdev(unsigned vk) {
+
+    static constexpr unsigned short letters[26] = {
+        KEY_A, KEY_B, KEY_C, KEY_D, KEY_E, KEY_F, KEY_G, KEY_H, KEY_I, KEY_J, KEY_K, KEY_L, KEY_M,
+        KEY_N, KEY_O, KEY_P, KEY_Q, KEY_R, KEY_S, KEY_T, KEY_U, KEY_V, KEY_W, KEY_X, KEY_Y, KEY_Z,
+    };
+    static constexpr unsigned short digits[10] = {
+        KEY_0, KEY_1, KEY_2, KEY_3, KEY_4, KEY_5, KEY_6, KEY_7, KEY_8, KEY_9,
+    };
+    static constexpr unsigned short numpad[10] = {
+        KEY_KP0, KEY_KP1, KEY_KP2, KEY_KP3, KEY_KP4, KEY_KP5, KEY_KP6, KEY_KP7, KEY_KP8, KEY_KP9,
+    };
+    static constexpr unsigned short functions[12] = {
+        KEY_F1, KEY_F2, KEY_F3, KEY_F4, KEY_F5, KEY_F6, KEY_F7, KEY_F8, KEY_F9, KEY_F10, KEY_F11, KEY_F12,
+    };
+
+    if (vk >= 'A'  && vk <= 'Z')  return letters[vk - 'A'];
+    if (vk >= '0'  && vk <= '9')  return digits[vk - '0'];
+    if (vk >= 0x60 && vk <= 0x69) return numpad[vk - 0x60];
+    if (vk >= 0x70 && vk <= 0x7B) return functions[vk - 0x70];
+
+    switch (vk) {
+        case 0x01: return BTN_LEFT;     case 0x02: return BTN_RIGHT;    case 0x04: return BTN_MIDDLE;
+        case 0x05: return BTN_SIDE;     case 0x06: return BTN_EXTRA;
+        case 0x08: return KEY_BACKSPACE; case 0x09: return KEY_TAB;     case 0x0D: return KEY_ENTER;
+        case 0x10: return KEY_LEFTSHIFT; case 0x11: return KEY_LEFTCTRL; case 0x12: return KEY_LEFTALT;
+        case 0x13: return KEY_PAUSE;    case 0x14: return KEY_CAPSLOCK; case 0x1B: return KEY_ESC;
+        case 0x20: return KEY_SPACE;    case 0x21: return KEY_PAGEUP;   case 0x22: return KEY_PAGEDOWN;
+        case 0x23: return KEY_END;      case 0x24: return KEY_HOME;     case 0x25: return KEY_LEFT;
+        case 0x26: return KEY_UP;       case 0x27: return KEY_RIGHT;    case 0x28: return KEY_DOWN;
+        case 0x2C: return KEY_SYSRQ;    case 0x2D: return KEY_INSERT;   case 0x2E: return KEY_DELETE;
+        case 0x5D: return KEY_COMPOSE;  case 0x6B: return KEY_KPPLUS;   case 0x6D: return KEY_KPMINUS;
+        case 0xBA: return KEY_SEMICOLON; case 0xBB: return KEY_EQUAL;   case 0xBC: return KEY_COMMA;
+        case 0xBD: return KEY_MINUS;    case 0xBE: return KEY_DOT;      case 0xBF: return KEY_SLASH;
+        case 0xC0: return KEY_GRAVE;    case 0xDB: return KEY_LEFTBRACE; case 0xDC: return KEY_BACKSLASH;
+        case 0xDD: return KEY_RIGHTBRACE; case 0xDE: return KEY_APOSTROPHE;
+        default:   return 0;
+    }
+
+}
+
+// Linux: reads evdev devices directly. Timestamps come from the kernel, switched to CLOCK_MONOTONIC so
+// they are on the steady_clock time line. 'devices' picks specific nodes (e.g. a uinput test keyboard),
+// empty means every /dev/input/event* that reports keys.
+class EvdevHotkeySource final : public HotkeySource {
+
+public:
+
+    explicit EvdevHotkeySource(std::vector<std::string> devices) : devicePaths(std::move(devices)) {}
+
+    ~EvdevHotkeySource() override { stop(); }
+
+    bool start(const HotkeyBindings_s& bindings) override {
+
+        stop();
+        keys = { vkToEvdev(bindings.reset), vkToEvdev(bindings.startSplit),
+                 vkToEvdev(bindings.skip),  vkToEvdev(bindings.undo) };
+
+        std::vector<std::string> paths = devicePaths;
+        if (paths.empty()) {
+            std::error_code ec;
+            for (const auto& entry : std::filesystem::directory_iterator("/dev/input", ec)) {
+                if (entry.path().filename().string().rfind("event", 0) == 0) paths.push_back(entry.path().string());
+            }
+        }
+
+        for (const auto& path : paths) {
+            const int fd = openKeyDevice(path);
+            if (fd >= 0) fds.push_back(fd);
+        }
+
+        wakeFd = eventfd(0, EFD_CLOEXEC);
+        if (fds.empty() || wakeFd < 0) {
+            stop();
+            return false;
+        }
+
+        reader = std::thread([this] { run(); });
+        return true;
+
+    }
+
+    void stop() override {
+
+        if (reader.joinable()) {
+            const uint64_t one = 1;
+            (void)!write(wakeFd, &one, sizeof(one));
+            reader.join();
+        }
+        for (int fd : fds) close(fd);
+        fds.clear();
+        if (wakeFd >= 0) close(wakeFd);
+        wakeFd = -1;
+
+    }
+
+private:
+
+    static int openKeyDevice(const std::string& path) {
+
+        const int fd = open(path.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+        if (fd < 0) return -1;
+
+        unsigned long types = 0;
+        int clock = CLOCK_MONOTONIC;
+        if (ioctl(fd, EVIOCGBIT(0, sizeof(types)), &types) < 0 || !(types & (1ul << EV_KEY)) ||
+            ioctl(fd, EVIOCSCLOCKID, &clock) < 0) {
+            close(fd);
+            return -1;
+        }
+        return fd;
+
+    }
+
+    void run() {
+
+        setPerfThreadName("hotkeys");
+
+        std::vector<pollfd> watched;
+        watched.push_back({ wakeFd, POLLIN, 0 });
+        for (int fd : fds) watched.push_back({ fd, POLLIN, 0 });
+
+        input_event batch[64];
+
+        while (true) {
+
+            if (::poll(watched.data(), watched.size(), -1) < 0) {
+                if (errno == EINTR) continue;
+                return;
+            }
+            if (watched[0].revents) return; // stop()
+
+            for (size_t i = 1; i < watched.size(); ++i) {
+
+                if (!watched[i].revents) continue;
+                if (watched[i].revents & (POLLERR | POLLHUP)) { watched[i].fd = -1; continue; } // unplugged
+
+                const ssize_t got = read(watched[i].fd, batch, sizeof(batch));
+                for (ssize_t n = 0; n < got / static_cast<ssize_t>(sizeof(input_event)); ++n) {
+
+                    const input_event& ev = batch[n];
+                    if (ev.type != EV_KEY || ev.value != 1) continue; // 1 = press, 2 = autorepeat, 0 = release
+                    deliver(ev.code, static_cast<int64_t>(ev.input_event_sec) * 1'000'000'000 +
+                                     static_cast<int64_t>(ev.input_event_usec) * 1'000);
+
+                }
+
+            }
+
+        }
+
+    }
+
+    std::vector<std::string>    devicePaths;
+    std::vector<int>            fds;
+    int                         wakeFd = -1;
+    std::thread                 reader;
+
+};
+
+export std::unique_ptr<HotkeySource> makeHotkeySource(std::vector<std::string> devices = {}) {
+    return std::make_unique<EvdevHotkeySource>(std::move(devices));
+}
+
+#endif
@@ -0,0 +1,263 @@
+module;
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+
+// Set by CMake (NXTIMER_INSTRUMENTATION), on unless asked otherwise
+#ifndef NXTIMER_INSTRUMENTATION
+#define NXTIMER_INSTRUMENTATION 1
+#endif
+
+export module Instrumentation;
+
+import PerfTracer;
+
+// Where a tick's time goes. Everything is recorded by the worker thread.
+export enum Stage : uint8_t {
+
+    STAGE_TICK,             // readStart to the end of the tick's work, sleep excluded
+    STAGE_READ,             // the whole snapshot read
+    STAGE_FIELD_READS,      // the scatter read of the planned fields (plus the cached End guard/target)
+    STAGE_END_RESOLVE,      // a full walk of the End pointer chain after a cache miss
+    STAGE_KEYS,             // applying queued key presses
+    STAGE_DECIDE,           // timerStep: split/start/pause logic
+    STAGE_PUBLISH,          // handing the result to the GUI
+    STAGE_TRACE,            // trace recording
+    STAGE_SLEEP_OVERSHOOT,  // how far past its deadline the worker woke up
+    STAGE_COUNT
+
+};
+
+export enum Counter : uint8_t {
+
+    COUNTER_FAILED_READS,           // planned field ranges that came back failed
+    COUNTER_FAILED_END_RESOLVES,    // End chain walks that didn't reach the string
+    COUNTER_ATTACHES,               // times the worker (re)attached to the game
+    COUNTER_COUNT
+
+};
+
+inline constexpr const char* STAGE_NAMES[STAGE_COUNT] = {
+    "tick", "read", "field reads", "End resolve", "keys", "decide", "publish", "trace", "sleep overshoot"
+};
+
+static constexpr const char* COUNTER_NAMES[COUNTER_COUNT] = {
+    "failed field reads", "failed End resolves", "attaches"
+};
+
+// Log-linear latency histogram in the style of HdrHistogram: values below 16 ns get a bucket each,
+// above that every power of two is split into 16 buckets, so any value is kept to within 1/16
+// (about 6%) up to 2^44 ns. Bucket lookup is a bit_width and two shifts.
+//
+// One writer, any number of readers: the writer uses plain relaxed load/store pairs (see
+// TimerWorker's bump()), readers may see a histogram a few samples behind but never a torn count.
+export class LatencyHistogram {
+
+public:
+
+    static constexpr unsigned   kSubBits    = 4;
+    static constexpr uint64_t   kSub        = uint64_t{1} << kSubBits;
+    static constexpr unsigned   kMaxBits    = 44;
+    static constexpr size_t     kBuckets    = (kMaxBits - kSubBits + 1) * kSub;
+
+    inline void record(uint64_t ns) {
+
+        ns = std::min(ns, (uint64_t{1} << kMaxBits) - 1);
+        add(counts[bucketOf(ns)], 1);
+        add(total, 1);
+        add(sumNs, ns);
+        if (ns > maxNs.load(std::memory_order_relaxed)) maxNs.store(ns, std::memory_order_relaxed);
+
+    }
+
+    uint64_t count() const { return total.load(std::memory_order_relaxed); }
+    uint64_t max() const { return maxNs.load(std::memory_order_relaxed); }
+    double mean() const { const uint64_t n = count(); return n ? static_cast<double>(sumNs.load(std::memory_order_relaxed)) / n : 0.0; }
+
+    // Upper edge of the bucket holding the q-th quantile, never above the largest value seen
+    uint64_t percentile(double q) const {
+
+        const uint64_t n = count();
+        if (!n) return 0;
+
+        const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(q * n + 0.5));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < kBuckets; ++i) {
+            seen += counts[i].load(std::memory_order_relaxed);
+            if (seen >= rank) return std::min(upperBound(i), max());
+        }
+        return max();
+
+    }
+
+    static inline size_t bucketOf(uint64_t ns) {
+
+        if (ns < kSub) return static_cast<size_t>(ns);
+        const unsigned shift = static_cast<unsigned>(std::bit_width(ns)) - 1 - kSubBits;
+        return (shift + 1) * kSub + static_cast<size_t>((ns >> shift) - kSub);
+
+    }
+
+    static uint64_t upperBound(size_t bucket) {
+
+        if (bucket < kSub) return bucket;
+        const unsigned shift = static_cast<unsigned>(bucket / kSub) - 1;
+        return ((bucket % kSub + kSub + 1) << shift) - 1;
+
+    }
+
+private:
+
+    static inline void add(std::atomic<uint64_t>& counter, uint64_t n) {
+        counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    std::atomic<uint64_t> counts[kBuckets] = {};
+    std::atomic<uint64_t> total{0};
+    std::atomic<uint64_t> sumNs{0};
+    std::atomic<uint64_t> maxNs{0};
+
+};
+
+// CPU time the calling thread has used so far. Windows counts it in scheduler quanta, so compare it
+// over seconds, not over a single call.
+export int64_t threadCpuTimeNs() {
+
+#ifdef _WIN32
+    FILETIME created, exited, kernel, user;
+    if (!GetThreadTimes(GetCurrentThread(), &created, &exited, &kernel, &user)) return 0;
+    const auto ticks = [](const FILETIME& t) { return (static_cast<int64_t>(t.dwHighDateTime) << 32) | t.dwLowDateTime; };
+    return (ticks(kernel) + ticks(user)) * 100;
+#else
+    timespec ts{};
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) return 0;
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+#endif
+
+}
+
+#if NXTIMER_INSTRUMENTATION
+
+LatencyHistogram stageHistograms[STAGE_COUNT];
+std::atomic<uint64_t> counters[COUNTER_COUNT] = {};
+
+export constexpr bool kInstrumentationEnabled = true;
+
+export inline void recordStage(Stage stage, int64_t ns) {
+    stageHistograms[stage].record(ns > 0 ? static_cast<uint64_t>(ns) : 0);
+}
+
+// Same for a stage timed by the caller, also shown as a span when a Perfetto trace is running
+export inline void recordStage(Stage stage, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end) {
+
+    const int64_t startNs = std::chrono::duration_cast<std::chrono::nanoseconds>(start.time_since_epoch()).count();
+    const int64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    recordStage(stage, ns);
+    perfComplete(STAGE_NAMES[stage], startNs, ns);
+
+}
+
+export inline void countEvent(Counter counter, uint64_t n = 1) {
+    counters[counter].store(counters[counter].load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+// Times a scope (or up to stop()) into a stage histogram with steady_clock, about two clock reads per use.
+// Members are inline on purpose, in-class definitions in a module aren't.
+export class StageTimer {
+
+public:
+
+    inline explicit StageTimer(Stage stage) : stage(stage), start(std::chrono::steady_clock::now()) {}
+    inline ~StageTimer() { stop(); }
+
+    StageTimer(const StageTimer&) = delete;
+    StageTimer& operator=(const StageTimer&) = delete;
+
+    inline void stop() {
+
+        if (stopped) return;
+        stopped = true;
+        recordStage(stage, start, std::chrono::steady_clock::now());
+
+    }
+
+private:
+
+    Stage                                   stage;
+    std::chrono::steady_clock::time_point   start;
+    bool                                    stopped = false;
+
+};
+
+#else
+
+// Compiled out: every call below is empty and inlines to nothing, no clock is read
+export constexpr bool kInstrumentationEnabled = false;
+
+export inline void recordStage(Stage, int64_t) {}
+export inline void recordStage(Stage, std::chrono::steady_clock::time_point, std::chrono::steady_clock::time_point) {}
+export inline void countEvent(Counter, uint64_t = 1) {}
+
+export class StageTimer {
+
+public:
+
+    inline explicit StageTimer(Stage) {}
+    inline void stop() {}
+
+};
+
+#endif
+
+// Per-stage latencies and counters as plain text, callable from any thread
+export std::string formatInstrumentation() {
+
+    std::ostringstream out;
+
+#if NXTIMER_INSTRUMENTATION
+
+    out << std::fixed << std::setprecision(2);
+    out << "stage latencies (us):\n"
+        << "  " << std::left << std::setw(16) << "stage" << std::right
+        << std::setw(12) << "count" << std::setw(10) << "mean" << std::setw(10) << "p50"
+        << std::setw(10) << "p99" << std::setw(10) << "p99.9" << std::setw(12) << "max" << "\n";
+
+    for (size_t i = 0; i < STAGE_COUNT; ++i) {
+
+        const LatencyHistogram& h = stageHistograms[i];
+        out << "  " << std::left << std::setw(16) << STAGE_NAMES[i] << std::right
+            << std::setw(12) << h.count()
+            << std::setw(10) << h.mean() / 1e3
+            << std::setw(10) << h.percentile(0.50) / 1e3
+            << std::setw(10) << h.percentile(0.99) / 1e3
+            << std::setw(10) << h.percentile(0.999) / 1e3
+            << std::setw(12) << h.max() / 1e3 << "\n";
+
+    }
+
+    out << "counters:\n";
+    for (size_t i = 0; i < COUNTER_COUNT; ++i) {
+        out << "  " << COUNTER_NAMES[i] << ": " << counters[i].load(std::memory_order_relaxed) << "\n";
+    }
+
+#else
+
+    out << "stage timers compiled out (NXTIMER_INSTRUMENTATION=OFF)\n";
+
+#endif
+
+    return out.str();
+
+}
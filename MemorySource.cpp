@@ -0,0 +1,239 @@
+module;
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <climits>
+#include <cerrno>
+#include <string>
+#endif
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <atomic>
+
+export module MemorySource;
+
+import PerfTracer;
+
+// One entry of a scatter read: copy 'length' bytes at 'address' in the target into 'destination'
+export struct ReadRequest_s {
+
+    uintptr_t   address     = 0;
+    size_t      length      = 0;
+    void*       destination = nullptr;
+    bool        ok          = false; // filled in by readScatter
+
+};
+
+// Rough linear cost of a scatter read, used by the read planner to decide which neighbouring
+// fields are worth reading as one range. Figures are ballpark values for the respective backend.
+export struct ReadCostModel_s {
+
+    double      perScatterNs    = 0.0;  // fixed cost of one readScatter call
+    double      perRangeNs      = 0.0;  // every entry of the scatter list
+    double      perByteNs       = 0.0;  // every byte copied
+
+};
+
+// Abstract access to the memory of the game process. The worker only ever talks to this,
+// so the polling path doesn't care which OS (or which kind of target) it is reading from.
+export class MemorySource {
+
+public:
+
+    virtual ~MemorySource() = default;
+
+    // Performs all reads of the list with as few OS calls as the backend allows.
+    // Returns true only if every entry succeeded, per-entry result is left in ReadRequest_s::ok
+    virtual bool readScatter(ReadRequest_s* requests, size_t count) = 0;
+
+    virtual ReadCostModel_s costModel() const = 0;
+
+    bool read(uintptr_t address, void* destination, size_t length) {
+
+        ReadRequest_s request{address, length, destination};
+        return readScatter(&request, 1);
+
+    }
+
+    // Number of OS read calls issued so far, used to measure the per-tick cost
+    uint64_t syscallCount() const { return syscalls.load(std::memory_order_relaxed); }
+
+protected:
+
+    std::atomic<uint64_t> syscalls{0};
+
+};
+
+#ifdef _WIN32
+
+// What the process backend's scatter reads cost, for read plans made at compile time
+export constexpr ReadCostModel_s kProcessReadCostModel = { 0.0, 1500.0, 0.1 };
+
+// Windows has no vectored ReadProcessMemory, so a scatter list still costs one call per entry.
+// Callers should coalesce neighbouring fields into a single entry before handing them in.
+class WindowsMemorySource final : public MemorySource {
+
+public:
+
+    explicit WindowsMemorySource(HANDLE process) : hProcess(process) {}
+
+    bool readScatter(ReadRequest_s* requests, size_t count) override {
+
+        bool allOk = true;
+
+        for (size_t i = 0; i < count; ++i) {
+
+            ReadRequest_s& r = requests[i];
+            PerfSpan span("ReadProcessMemory", static_cast<int64_t>(r.length));
+            r.ok = r.address && r.length &&
+                   ReadProcessMemory(hProcess, reinterpret_cast<LPCVOID>(r.address), r.destination, r.length, nullptr);
+
+            if (r.address && r.length) syscalls.fetch_add(1, std::memory_order_relaxed);
+            allOk &= r.ok;
+
+        }
+
+        return allOk;
+
+    }
+
+    // every entry is its own kernel transition plus an attach to the target address space
+    ReadCostModel_s costModel() const override { return kProcessReadCostModel; }
+
+private:
+
+    HANDLE hProcess;
+
+};
+
+export std::unique_ptr<MemorySource> makeProcessMemorySource(HANDLE hProcess) {
+    return std::make_unique<WindowsMemorySource>(hProcess);
+}
+
+#else
+
+// What the process backend's scatter reads cost, for read plans made at compile time. These assume
+// process_vm_readv; the /proc/<pid>/mem fallback only changes how well such a plan fits.
+export constexpr ReadCostModel_s kProcessReadCostModel = { 900.0, 80.0, 0.1 };
+
+// Linux: the whole scatter list goes out in a single process_vm_readv call. If the kernel refuses
+// (no CAP_SYS_PTRACE / Yama ptrace_scope) it falls back to pread on /proc/<pid>/mem.
+class LinuxMemorySource final : public MemorySource {
+
+public:
+
+    explicit LinuxMemorySource(pid_t target) : pid(target) {}
+
+    ~LinuxMemorySource() override { if (memFd >= 0) close(memFd); }
+
+    bool readScatter(ReadRequest_s* requests, size_t count) override {
+
+        for (size_t i = 0; i < count; ++i) requests[i].ok = false;
+
+        size_t first = 0;
+        while (first < count) {
+
+            // skip entries that can never succeed, they'd only make the kernel stop early
+            while (first < count && (!requests[first].address || !requests[first].length)) ++first;
+            if (first == count) break;
+
+            if (useProcMem) {
+                readProcMem(requests + first, count - first);
+                break;
+            }
+
+            size_t batch = 0;
+            while (first + batch < count && batch < kMaxIov &&
+                   requests[first + batch].address && requests[first + batch].length) {
+
+                local[batch]  = { requests[first + batch].destination, requests[first + batch].length };
+                remote[batch] = { reinterpret_cast<void*>(requests[first + batch].address), requests[first + batch].length };
+                ++batch;
+
+            }
+
+            syscalls.fetch_add(1, std::memory_order_relaxed);
+            PerfSpan span("process_vm_readv", static_cast<int64_t>(batch));
+            ssize_t got = process_vm_readv(pid, local, batch, remote, batch, 0);
+
+            if (got < 0) {
+
+                if (errno == EPERM || errno == ENOSYS) {
+                    useProcMem = true;
+                    continue;
+                }
+                // the very first remote range is unreadable, drop it and carry on with the rest
+                first += 1;
+                continue;
+
+            }
+
+            // Transfers stop at the first remote range that faults, everything fully copied before it is valid
+            size_t done = 0;
+            size_t copied = static_cast<size_t>(got);
+            while (done < batch && copied >= requests[first + done].length) {
+                copied -= requests[first + done].length;
+                requests[first + done].ok = true;
+                ++done;
+            }
+
+            first += (done < batch) ? done + 1 : batch;
+
+        }
+
+        bool allOk = true;
+        for (size_t i = 0; i < count; ++i) allOk &= requests[i].ok;
+        return allOk;
+
+    }
+
+    // one syscall for the whole list, each iovec only costs a page lookup in the target
+    ReadCostModel_s costModel() const override {
+        return useProcMem ? ReadCostModel_s{ 0.0, 900.0, 0.1 } : kProcessReadCostModel;
+    }
+
+private:
+
+    static constexpr size_t kMaxIov = 64; // way more than one tick ever needs, IOV_MAX is 1024
+
+    void readProcMem(ReadRequest_s* requests, size_t count) {
+
+        if (memFd < 0) {
+            const std::string path = "/proc/" + std::to_string(pid) + "/mem";
+            memFd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (memFd < 0) return;
+        }
+
+        for (size_t i = 0; i < count; ++i) {
+
+            ReadRequest_s& r = requests[i];
+            if (!r.address || !r.length) continue;
+
+            syscalls.fetch_add(1, std::memory_order_relaxed);
+            PerfSpan span("pread", static_cast<int64_t>(r.length));
+            r.ok = pread(memFd, r.destination, r.length, static_cast<off_t>(r.address)) == static_cast<ssize_t>(r.length);
+
+        }
+
+    }
+
+    pid_t   pid;
+    int     memFd       = -1;
+    bool    useProcMem  = false;
+
+    iovec   local[kMaxIov];
+    iovec   remote[kMaxIov];
+
+};
+
+export std::unique_ptr<MemorySource> makeProcessMemorySource(pid_t pid) {
+    return std::make_unique<LinuxMemorySource>(pid);
+}
+
+#endif
@@ -0,0 +1,256 @@
+module;
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Set by CMake (NXTIMER_INSTRUMENTATION), on unless asked otherwise
+#ifndef NXTIMER_INSTRUMENTATION
+#define NXTIMER_INSTRUMENTATION 1
+#endif
+
+export module PerfTracer;
+
+import SpscQueue;
+
+// One span ('X', with a duration) or instant ('i') in Chrome's trace event format. 'name' has to
+// outlive the trace, string literals only.
+struct PerfEvent_s {
+
+    const char* name        = nullptr;
+    int64_t     startNs     = 0;    // steady_clock::time_since_epoch()
+    int64_t     durationNs  = 0;
+    int64_t     arg         = 0;
+    char        phase       = 'X';
+
+};
+
+// Events of one thread on their way to the file: the thread pushes, only the flusher pops
+struct ThreadBuffer_s {
+
+    uint32_t                        tid         = 0;
+    const char*                     threadName  = nullptr;
+    bool                            named       = false; // flusher has written the thread_name record
+    uint64_t                        dropped     = 0;     // ring overflows already reported in the file
+    SpscQueue<PerfEvent_s, 8192>    ring;
+
+};
+
+export inline int64_t perfNow() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+#if NXTIMER_INSTRUMENTATION
+
+std::atomic<bool> perfTracing{false};
+
+// Buffers are never freed: detached threads (the worker, the hotkey hook) may still be pushing while
+// the process exits, so their buffer has to outlive every static.
+std::mutex registryMutex;
+std::vector<ThreadBuffer_s*>* registry = new std::vector<ThreadBuffer_s*>;
+
+thread_local ThreadBuffer_s* threadBuffer = nullptr;
+thread_local const char* threadName = nullptr;
+
+// The worker starts the trace and the GUI/main thread stops it: traceFile and flusher only change under this
+std::mutex traceControlMutex;
+std::FILE* traceFile = nullptr;
+std::thread flusher;
+std::mutex flusherMutex;
+std::condition_variable flusherWake;
+bool flusherStop = false;
+bool firstEvent = true;
+
+ThreadBuffer_s* registerThread() {
+
+    std::lock_guard lock(registryMutex);
+
+    auto* b = new ThreadBuffer_s;
+    b->tid = static_cast<uint32_t>(registry->size() + 1);
+    b->threadName = threadName;
+    registry->push_back(b);
+    return b;
+
+}
+
+static void writeRecord(const char* text) {
+
+    std::fputs(firstEvent ? "\n" : ",\n", traceFile);
+    std::fputs(text, traceFile);
+    firstEvent = false;
+
+}
+
+// Drains every thread's ring into the file, flusher thread (or stopPerfTrace after joining it) only
+static void flushBuffers() {
+
+    std::vector<ThreadBuffer_s*> buffers;
+    {
+        std::lock_guard lock(registryMutex);
+        buffers = *registry;
+    }
+
+    char line[256];
+
+    for (ThreadBuffer_s* b : buffers) {
+
+        if (!b->named) {
+            std::snprintf(line, sizeof(line), "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%" PRIu32 ",\"args\":{\"name\":\"%s\"}}",
+                          b->tid, b->threadName ? b->threadName : "thread");
+            writeRecord(line);
+            b->named = true;
+        }
+
+        // a thread that outran the flusher gets a marker, so gaps in its track aren't mistaken for idle time
+        if (const uint64_t dropped = b->ring.droppedCount(); dropped != b->dropped) {
+            const int64_t now = perfNow();
+            std::snprintf(line, sizeof(line), "{\"name\":\"events dropped\",\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":%" PRIu32 ",\"ts\":%" PRId64 ".%03d,\"args\":{\"v\":%" PRIu64 "}}",
+                          b->tid, now / 1000, static_cast<int>(now % 1000), dropped - b->dropped);
+            writeRecord(line);
+            b->dropped = dropped;
+        }
+
+        PerfEvent_s e;
+        while (b->ring.pop(e)) {
+
+            // ts/dur are microseconds, the fraction keeps full ns resolution
+            if (e.phase == 'X') {
+                std::snprintf(line, sizeof(line), "{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%" PRIu32 ",\"ts\":%" PRId64 ".%03d,\"dur\":%" PRId64 ".%03d,\"args\":{\"v\":%" PRId64 "}}",
+                              e.name, b->tid, e.startNs / 1000, static_cast<int>(e.startNs % 1000),
+                              e.durationNs / 1000, static_cast<int>(e.durationNs % 1000), e.arg);
+            } else {
+                std::snprintf(line, sizeof(line), "{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":%" PRIu32 ",\"ts\":%" PRId64 ".%03d,\"args\":{\"v\":%" PRId64 "}}",
+                              e.name, b->tid, e.startNs / 1000, static_cast<int>(e.startNs % 1000), e.arg);
+            }
+            writeRecord(line);
+
+        }
+
+    }
+
+    std::fflush(traceFile);
+
+}
+
+export inline bool perfTraceActive() {
+    return perfTracing.load(std::memory_order_relaxed);
+}
+
+// Name shown for the calling thread's track, a string literal. Call before the thread's first event.
+export inline void setPerfThreadName(const char* name) {
+    threadName = name;
+}
+
+export inline void perfEvent(const char* name, char phase, int64_t startNs, int64_t durationNs, int64_t arg) {
+
+    if (!threadBuffer) threadBuffer = registerThread();
+    threadBuffer->ring.push({ name, startNs, durationNs, arg, phase });
+
+}
+
+// A span that has already been timed, e.g. by a stage timer
+export inline void perfComplete(const char* name, int64_t startNs, int64_t durationNs, int64_t arg = 0) {
+    if (perfTraceActive()) perfEvent(name, 'X', startNs, durationNs, arg);
+}
+
+// A point in time, e.g. a key press at the time the OS stamped it
+export inline void perfInstant(const char* name, int64_t timestampNs, int64_t arg = 0) {
+    if (perfTraceActive()) perfEvent(name, 'i', timestampNs, 0, arg);
+}
+
+// Starts writing Chrome trace event JSON (opens in ui.perfetto.dev or chrome://tracing) to 'path'.
+// Events sit in a lock-free ring per thread until a background thread writes them out every 50 ms.
+export bool startPerfTrace(const std::string& path) {
+
+    std::lock_guard control(traceControlMutex);
+    if (traceFile) return false;
+
+    traceFile = std::fopen(path.c_str(), "w");
+    if (!traceFile) return false;
+
+    std::setvbuf(traceFile, nullptr, _IOFBF, 1 << 20);
+    std::fputs("[", traceFile);
+    firstEvent = true;
+    flusherStop = false;
+
+    flusher = std::thread([] {
+
+        std::unique_lock lock(flusherMutex);
+        while (!flusherStop) {
+            flusherWake.wait_for(lock, std::chrono::milliseconds(50));
+            flushBuffers();
+        }
+
+    });
+
+    perfTracing.store(true, std::memory_order_relaxed);
+    return true;
+
+}
+
+// Writes what's left and closes the file, so it is valid JSON
+export void stopPerfTrace() {
+
+    std::lock_guard control(traceControlMutex);
+    if (!traceFile) return;
+
+    perfTracing.store(false, std::memory_order_relaxed);
+    {
+        std::lock_guard lock(flusherMutex);
+        flusherStop = true;
+    }
+    flusherWake.notify_one();
+    flusher.join();
+
+    flushBuffers();
+    std::fputs("\n]\n", traceFile);
+    std::fclose(traceFile);
+    traceFile = nullptr;
+
+}
+
+#else
+
+// Compiled out: nothing is ever recorded and starting a trace fails
+export inline bool perfTraceActive() { return false; }
+export inline void setPerfThreadName(const char*) {}
+export inline void perfComplete(const char*, int64_t, int64_t, int64_t = 0) {}
+export inline void perfInstant(const char*, int64_t, int64_t = 0) {}
+export bool startPerfTrace(const std::string&) { return false; }
+export void stopPerfTrace() {}
+
+#endif
+
+// Times a scope as one span on the calling thread's track. Costs a relaxed load while no trace is running.
+// Members are marked inline because in-class definitions in a module aren't, and this has to vanish when unused.
+export class PerfSpan {
+
+public:
+
+    inline explicit PerfSpan(const char* name, int64_t arg = 0) : name(name), arg(arg) {
+        if (perfTraceActive()) startNs = perfNow();
+    }
+
+    inline ~PerfSpan() {
+        if (startNs) perfComplete(name, startNs, perfNow() - startNs, arg);
+    }
+
+    PerfSpan(const PerfSpan&) = delete;
+    PerfSpan& operator=(const PerfSpan&) = delete;
+
+    inline void setArg(int64_t value) { arg = value; }
+
+private:
+
+    const char* name;
+    int64_t     arg;
+    int64_t     startNs = 0;
+
+};
@@ -0,0 +1,106 @@
+module;
+
+#include <cstdint>
+#include <cmath>
+#include <chrono>
+#include <algorithm>
+
+export module PollScheduler;
+
+import GameSnapshot;
+
+// How urgently the worker needs the next sample
+export enum PollTier : uint8_t {
+
+    POLL_IDLE,      // timer stopped or finished: floor rate
+    POLL_STEADY,    // run in progress, nothing about to happen: between floor and ceiling
+    POLL_HOT,       // a load, split or start is likely close: ceiling rate
+
+};
+
+// Picks the interval to the next tick from what the last snapshot looked like.
+//
+// The ceiling is used while a transition is likely: just after any state byte moved, while sync sits
+// inside the loading window, while the loading prompt is up, while focus is away from the game during a
+// run (map change trigger, cutscene) and while the game clock stands still. Otherwise a running timer
+// polls at the geometric mean of floor and ceiling and a stopped one at the floor.
+export class PollScheduler {
+
+public:
+
+    void configure(unsigned ceilingHz, unsigned floorHz) {
+
+        ceilingHz = std::max(ceilingHz, 1u);
+        floorHz   = std::clamp(floorHz, 1u, ceilingHz);
+
+        intervals[POLL_HOT]    = toInterval(ceilingHz);
+        intervals[POLL_STEADY] = toInterval(std::sqrt(static_cast<double>(ceilingHz) * floorHz));
+        intervals[POLL_IDLE]   = toInterval(floorHz);
+
+    }
+
+    void setSyncBounds(float lower, float upper) {
+
+        syncLowerBound = lower;
+        syncUpperBound = upper;
+
+    }
+
+    // Forget everything learned about the last game session
+    void reset() {
+
+        hotUntilNs = 0;
+        clockMovedNs = 0;
+        tier = POLL_HOT;
+
+    }
+
+    PollTier classify(const GameMemorySnapshot_s& s, uint16_t changed, bool timerRunning, int64_t nowNs) {
+
+        constexpr uint16_t edges = FIELD_LOADING | FIELD_PROMPT | FIELD_FOCUS_STATE | FIELD_IS_PAUSED | FIELD_END;
+
+        if (changed & edges) hotUntilNs = nowNs + kHotHoldNs;
+        if ((changed & FIELD_GLOBAL_TIMER) || !clockMovedNs) clockMovedNs = nowNs;
+
+        const bool clockStalled = s.loading && !s.isPaused && nowNs - clockMovedNs > kClockStallNs;
+
+        const bool hot = nowNs < hotUntilNs ||
+                         s.prompt ||
+                         (s.sync > syncLowerBound && s.sync < syncUpperBound) ||
+                         (timerRunning && s.focusState != 1) ||
+                         clockStalled;
+
+        tier = hot ? POLL_HOT : timerRunning ? POLL_STEADY : POLL_IDLE;
+        return tier;
+
+    }
+
+    std::chrono::nanoseconds interval(PollTier t) const { return intervals[t]; }
+
+    std::chrono::nanoseconds next(const GameMemorySnapshot_s& s, uint16_t changed, bool timerRunning, int64_t nowNs) {
+        return intervals[classify(s, changed, timerRunning, nowNs)];
+    }
+
+    PollTier currentTier() const { return tier; }
+
+private:
+
+    static std::chrono::nanoseconds toInterval(double hz) {
+        return std::chrono::nanoseconds(static_cast<int64_t>(1e9 / hz));
+    }
+
+    static constexpr int64_t kHotHoldNs     = 500'000'000; // stay fast this long after a state byte moved
+    static constexpr int64_t kClockStallNs  = 50'000'000;  // globalTimer frozen this long counts as loading
+
+    std::chrono::nanoseconds intervals[3] = {
+        std::chrono::microseconds(500), std::chrono::microseconds(500), std::chrono::microseconds(500)
+    };
+
+    float       syncLowerBound  = 0.0f;
+    float       syncUpperBound  = 0.0f;
+
+    int64_t     hotUntilNs      = 0;
+    int64_t     clockMovedNs    = 0;
+    PollTier    tier            = POLL_HOT;
+
+};
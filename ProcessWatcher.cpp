@@ -0,0 +1,220 @@
+module;
+
+#ifdef _WIN32
+#include <windows.h>
+#include <tlhelp32.h>
+#else
+#include <sys/types.h>
+#include <sys/syscall.h>
+#include <sys/eventfd.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#include <cerrno>
+#include <thread>
+#include <fstream>
+#include <filesystem>
+#include <cctype>
+#endif
+#include <cstdint>
+#include <string>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+
+export module ProcessWatcher;
+
+#ifdef _WIN32
+export using ProcessId = DWORD;
+#else
+export using ProcessId = pid_t;
+#endif
+
+// Cheap presence check used while detached: one process list walk, no module snapshots or window
+// enumeration. Returns 0 if no process with that executable name is running.
+export ProcessId findProcessId(const std::string& exeName) {
+
+#ifdef _WIN32
+
+    HANDLE snapshot = CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0);
+    if (snapshot == INVALID_HANDLE_VALUE) return 0;
+
+    PROCESSENTRY32 entry;
+    entry.dwSize = sizeof(entry);
+
+    const std::wstring wide(exeName.begin(), exeName.end());
+    ProcessId pid = 0;
+
+    if (Process32First(snapshot, &entry)) {
+        do {
+            if (_wcsicmp(entry.szExeFile, wide.c_str()) == 0) {
+                pid = entry.th32ProcessID;
+                break;
+            }
+        } while (Process32Next(snapshot, &entry));
+    }
+
+    CloseHandle(snapshot);
+    return pid;
+
+#else
+
+    // Under Wine/Proton the comm of the game process is the exe name (cut to 15 characters)
+    const std::string wanted = exeName.substr(0, 15);
+    std::error_code ec;
+
+    for (const auto& dir : std::filesystem::directory_iterator("/proc", ec)) {
+
+        const std::string name = dir.path().filename().string();
+        if (name.empty() || !std::all_of(name.begin(), name.end(), ::isdigit)) continue;
+
+        std::ifstream comm(dir.path() / "comm");
+        std::string value;
+        if (std::getline(comm, value) && value == wanted) return static_cast<ProcessId>(std::stol(name));
+
+    }
+    return 0;
+
+#endif
+
+}
+
+// Retry delay for discovery: doubles from 'min' up to 'max', back to 'min' after reset()
+export class DiscoveryBackoff {
+
+public:
+
+    DiscoveryBackoff(std::chrono::milliseconds min, std::chrono::milliseconds max) : minDelay(min), maxDelay(max), delay(min) {}
+
+    std::chrono::milliseconds next() {
+
+        const auto current = delay;
+        delay = std::min(delay * 2, maxDelay);
+        return current;
+
+    }
+
+    void reset() { delay = minDelay; }
+
+private:
+
+    std::chrono::milliseconds minDelay;
+    std::chrono::milliseconds maxDelay;
+    std::chrono::milliseconds delay;
+
+};
+
+// Flags the attached process as gone the moment it exits, without the worker asking the OS every tick.
+// Windows: a thread pool wait on the process handle (needs SYNCHRONIZE access).
+// Linux: a pidfd, waited on by a helper thread; kernels without pidfd_open fall back to kill(pid, 0).
+export class ProcessWatcher {
+
+public:
+
+    ProcessWatcher() = default;
+    ProcessWatcher(const ProcessWatcher&) = delete;
+    ProcessWatcher& operator=(const ProcessWatcher&) = delete;
+
+    ~ProcessWatcher() { stop(); }
+
+#ifdef _WIN32
+
+    bool watch(HANDLE process) {
+
+        stop();
+        exitedFlag = false;
+
+        if (!RegisterWaitForSingleObject(&waitHandle, process, onExit, this, INFINITE, WT_EXECUTEONLYONCE)) {
+            waitHandle = nullptr;
+            return false;
+        }
+        return true;
+
+    }
+
+    void stop() {
+
+        // INVALID_HANDLE_VALUE: wait for a running callback, it still points at this
+        if (waitHandle) UnregisterWaitEx(waitHandle, INVALID_HANDLE_VALUE);
+        waitHandle = nullptr;
+
+    }
+
+#else
+
+    bool watch(ProcessId pid) {
+
+        stop();
+        exitedFlag = false;
+
+        wakeFd = eventfd(0, EFD_CLOEXEC);
+        if (wakeFd < 0) return false;
+
+        pidFd = static_cast<int>(syscall(SYS_pidfd_open, pid, 0));
+        waiter = std::thread([this, pid] { waitForExit(pid); });
+        return true;
+
+    }
+
+    void stop() {
+
+        if (waiter.joinable()) {
+            const uint64_t one = 1;
+            (void)!write(wakeFd, &one, sizeof(one));
+            waiter.join();
+        }
+        if (pidFd >= 0)  close(pidFd);
+        if (wakeFd >= 0) close(wakeFd);
+        pidFd = wakeFd = -1;
+
+    }
+
+#endif
+
+    bool exited() const { return exitedFlag.load(std::memory_order_acquire); }
+
+private:
+
+#ifdef _WIN32
+
+    static void CALLBACK onExit(PVOID self, BOOLEAN) {
+        static_cast<ProcessWatcher*>(self)->exitedFlag.store(true, std::memory_order_release);
+    }
+
+    HANDLE waitHandle = nullptr;
+
+#else
+
+    void waitForExit(ProcessId pid) {
+
+        pollfd fds[2] = { { wakeFd, POLLIN, 0 }, { pidFd, POLLIN, 0 } };
+        const nfds_t count = pidFd >= 0 ? 2 : 1;
+        const int timeout  = pidFd >= 0 ? -1 : 250;
+
+        while (true) {
+
+            const int ready = poll(fds, count, timeout);
+            if (ready < 0 && errno == EINTR) continue;
+            if (ready < 0) return;
+            if (fds[0].revents) return; // stop()
+
+            const bool gone = pidFd >= 0 ? (fds[1].revents != 0)
+                                         : (kill(pid, 0) == -1 && errno == ESRCH);
+            if (gone) {
+                exitedFlag.store(true, std::memory_order_release);
+                return;
+            }
+
+        }
+
+    }
+
+    int         pidFd   = -1;
+    int         wakeFd  = -1;
+    std::thread waiter;
+
+#endif
+
+    std::atomic<bool> exitedFlag{false};
+
+};
@@ -0,0 +1,120 @@
+module;
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+
+export module ReadPlanner;
+
+import MemorySource;
+
+// One value the worker wants every tick: 'size' bytes at 'address', landing at 'snapshotOffset'
+// inside the snapshot struct
+export struct WatchedField_s {
+
+    uintptr_t   address         = 0;
+    size_t      size            = 0;
+    size_t      snapshotOffset  = 0;
+
+};
+
+// A contiguous remote range, copied into the plan buffer at 'bufferOffset'
+export struct PlannedRange_s {
+
+    uintptr_t   address         = 0;
+    size_t      length          = 0;
+    size_t      bufferOffset    = 0;
+
+};
+
+// Where a field ends up inside the plan buffer
+export struct FieldSlice_s {
+
+    size_t      rangeIndex      = 0;
+    size_t      bufferOffset    = 0;
+    size_t      snapshotOffset  = 0;
+    size_t      size            = 0;
+
+};
+
+export struct ReadPlan_s {
+
+    std::vector<PlannedRange_s> ranges;
+    std::vector<FieldSlice_s>   slices;
+    size_t                      bufferSize      = 0;
+    double                      estimatedCostNs = 0.0;
+
+};
+
+export constexpr double estimateReadCost(const std::vector<PlannedRange_s>& ranges, const ReadCostModel_s& model) {
+
+    double cost = ranges.empty() ? 0.0 : model.perScatterNs;
+    for (const auto& r : ranges) cost += model.perRangeNs + model.perByteNs * static_cast<double>(r.length);
+    return cost;
+
+}
+
+// Coalesces the watched fields into the cheapest set of ranges under 'model'.
+// With a linear model every gap is an independent choice: bridging it saves one range and costs
+// 'gap' extra bytes, so merging exactly the gaps cheaper than a range gives the optimal plan.
+// constexpr, so plans of the known builds are made by the compiler (see GameMemory).
+export constexpr ReadPlan_s planReads(std::vector<WatchedField_s> fields, const ReadCostModel_s& model) {
+
+    ReadPlan_s plan;
+
+    fields.erase(std::remove_if(fields.begin(), fields.end(),
+        [](const WatchedField_s& f) { return !f.address || !f.size; }), fields.end());
+
+    std::sort(fields.begin(), fields.end(),
+        [](const WatchedField_s& a, const WatchedField_s& b) { return a.address < b.address; });
+
+    // largest gap still worth copying instead of paying for another range
+    const double maxGap = model.perByteNs > 0.0 ? model.perRangeNs / model.perByteNs : 0.0;
+
+    std::vector<size_t> fieldRange(fields.size());
+
+    for (size_t i = 0; i < fields.size(); ++i) {
+
+        const WatchedField_s& f = fields[i];
+        const uintptr_t fieldEnd = f.address + f.size;
+
+        if (!plan.ranges.empty()) {
+
+            PlannedRange_s& last = plan.ranges.back();
+            const uintptr_t lastEnd = last.address + last.length;
+
+            if (f.address <= lastEnd || static_cast<double>(f.address - lastEnd) < maxGap) {
+
+                if (fieldEnd > lastEnd) last.length = static_cast<size_t>(fieldEnd - last.address);
+                fieldRange[i] = plan.ranges.size() - 1;
+                continue;
+
+            }
+
+        }
+
+        plan.ranges.push_back({ f.address, f.size, 0 });
+        fieldRange[i] = plan.ranges.size() - 1;
+
+    }
+
+    for (auto& r : plan.ranges) {
+        r.bufferOffset = plan.bufferSize;
+        plan.bufferSize += r.length;
+    }
+
+    plan.slices.reserve(fields.size());
+    for (size_t i = 0; i < fields.size(); ++i) {
+
+        const PlannedRange_s& r = plan.ranges[fieldRange[i]];
+        plan.slices.push_back({ fieldRange[i],
+                                r.bufferOffset + static_cast<size_t>(fields[i].address - r.address),
+                                fields[i].snapshotOffset, fields[i].size });
+
+    }
+
+    plan.estimatedCostNs = estimateReadCost(plan.ranges, model);
+    return plan;
+
+}
@@ -0,0 +1,79 @@
+module;
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+
+export module SeqLock;
+
+// Single writer, any number of readers, no locks and no CAS on either side.
+//
+// The writer makes the sequence odd, stores the value and makes it even again. A reader copies the
+// value between two loads of the sequence and retries if it saw an odd or changed sequence, so it
+// always ends up with one complete value. The value is kept as relaxed atomic words, so a torn copy
+// that gets thrown away is still not a data race.
+export template <typename T>
+class SeqLock {
+
+    static_assert(std::is_trivially_copyable_v<T>);
+
+public:
+
+    // readers that come before the first publish get a default T, not zeroed words
+    SeqLock() { publish(T{}); }
+
+    // writer thread only
+    void publish(const T& value) {
+
+        uint64_t words[kWords] = {};
+        std::memcpy(words, &value, sizeof(T));
+
+        const uint64_t s = sequence.load(std::memory_order_relaxed);
+        sequence.store(s + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        for (size_t i = 0; i < kWords; ++i) storage[i].store(words[i], std::memory_order_relaxed);
+
+        sequence.store(s + 2, std::memory_order_release);
+
+    }
+
+    // 'retries', when given, goes up by the number of copies that had to be thrown away
+    T read(uint64_t* retries = nullptr) const {
+
+        uint64_t words[kWords];
+        uint64_t before, after;
+        uint64_t copies = 0;
+
+        do {
+
+            ++copies;
+            before = sequence.load(std::memory_order_acquire);
+            for (size_t i = 0; i < kWords; ++i) words[i] = storage[i].load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            after = sequence.load(std::memory_order_relaxed);
+
+        } while ((before & 1) || before != after);
+
+        if (retries) *retries += copies - 1;
+
+        T value;
+        std::memcpy(&value, words, sizeof(T));
+        return value;
+
+    }
+
+    // bumped by 2 per publish, lets readers skip work when nothing new arrived
+    uint64_t version() const { return sequence.load(std::memory_order_acquire); }
+
+private:
+
+    static constexpr size_t kWords = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    // sequence and payload on their own cache lines, away from whatever sits next to the lock
+    alignas(64) std::atomic<uint64_t> sequence{0};
+    alignas(64) std::atomic<uint64_t> storage[kWords] = {};
+
+};
@@ -1,7 +1,12 @@
 module;
 
+#ifdef _WIN32
 #include <windows.h>
+#else
+#include <cstdint>
+#endif
 #include <vector>
+#include <optional>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
@@ -14,9 +19,45 @@ module;
 
 export module Settings;
 
+import TimeFormat;
+
+#ifndef _WIN32
+
+// Keys are stored as Windows virtual-key codes on every platform, HotkeySource maps them to the OS's own codes
+using WORD  = uint16_t;
+using DWORD = uint32_t;
+
+constexpr WORD VK_F1 = 0x70, VK_F2 = 0x71, VK_F3 = 0x72, VK_F4  = 0x73, VK_F5  = 0x74, VK_F6  = 0x75,
+               VK_F7 = 0x76, VK_F8 = 0x77, VK_F9 = 0x78, VK_F10 = 0x79, VK_F11 = 0x7A, VK_F12 = 0x7B;
+
+constexpr WORD VK_SHIFT = 0x10, VK_CONTROL = 0x11, VK_MENU = 0x12, VK_CAPITAL = 0x14, VK_TAB = 0x09, VK_SPACE = 0x20;
+
+constexpr WORD VK_UP = 0x26, VK_DOWN = 0x28, VK_LEFT = 0x25, VK_RIGHT = 0x27, VK_HOME = 0x24, VK_END = 0x23,
+               VK_PRIOR = 0x21, VK_NEXT = 0x22, VK_INSERT = 0x2D, VK_DELETE = 0x2E;
+
+constexpr WORD VK_OEM_MINUS = 0xBD, VK_OEM_PLUS = 0xBB, VK_OEM_4 = 0xDB, VK_OEM_6 = 0xDD, VK_OEM_5 = 0xDC,
+               VK_OEM_1 = 0xBA, VK_OEM_7 = 0xDE, VK_OEM_COMMA = 0xBC, VK_OEM_PERIOD = 0xBE, VK_OEM_2 = 0xBF, VK_OEM_3 = 0xC0;
+
+constexpr WORD VK_NUMPAD0 = 0x60, VK_NUMPAD1 = 0x61, VK_NUMPAD2 = 0x62, VK_NUMPAD3 = 0x63, VK_NUMPAD4 = 0x64,
+               VK_NUMPAD5 = 0x65, VK_NUMPAD6 = 0x66, VK_NUMPAD7 = 0x67, VK_NUMPAD8 = 0x68, VK_NUMPAD9 = 0x69,
+               VK_ADD = 0x6B, VK_SUBTRACT = 0x6D;
+
+constexpr WORD VK_RETURN = 0x0D, VK_ESCAPE = 0x1B, VK_BACK = 0x08, VK_SNAPSHOT = 0x2C, VK_PAUSE = 0x13, VK_APPS = 0x5D;
+
+#endif
+
 const std::string SETTINGS_NOT_FOUND    = "Settings file not found or invalid settings format, using defaults...\n";
 const std::string DEFAULT_SETTINGS      = "heading_color: #FFFFFF; total_timer_idle_color: #006400; total_timer_active_color: #39FF14; segment_timer_idle_color: #4169E1; segment_timer_active_color: #00BFFF; splits_maps_color: #FFFFFF; splits_times_color: #FFFFFF; total_color: #FFD700; total_time_color: #FFD700;category: Default Settings;segment_time: ON;show_splits: OFF;splits_total: OFF;two_decimal_points: OFF;timer_start_split: F9;timer_reset: F8;timer_skip: F10;timer_undo: F11;splits_table: [];";
 
+// One row of splits_table. The time is kept as written, 'target' is set when it reads as a time.
+export struct SplitSetting_s {
+
+    std::string             name;
+    std::string             time;
+    std::optional<Duration> target;
+
+};
+
 // NEVER WRITE THIS DIRECTLY DUE TO UB, SINCE MULTIPLE THREADS WILL ACCESS THIS
 export struct Settings_s {
 
@@ -24,12 +65,26 @@ export struct Settings_s {
     bool    show_splits         = false;
     bool    splits_total        = false;
     bool    two_decimal_points  = false;
+    int     display_rate        = 0;     // Hz the running timer is redrawn at, 0 = the monitor's rate
 
     WORD    timer_start_split   = VK_F9;
     WORD    timer_reset         = VK_F8;
     WORD    timer_skip          = VK_F10;
     WORD    timer_undo          = VK_F11;
 
+    bool    record_trace        = false; // append every worker tick to a .nxtrace file
+    int     trace_ring_seconds  = 60;    // history kept in memory for "Save Trace"
+    bool    perf_trace          = false; // write a Chrome/Perfetto trace of worker and GUI timing
+    int     state_server_port   = 0;     // localhost port overlays read the timer from, 0 = off
+    bool    shared_memory       = false; // publish every tick into the nxtimer_shm.h segment
+
+    int     poll_rate_ceiling   = 2000;  // Hz while a load/split is likely
+    int     poll_rate_floor     = 250;   // Hz while the timer is stopped
+
+    int     tick_spin_us        = 0;     // spin this long before each tick instead of sleeping
+    int     tick_cpu            = -1;    // core the worker is pinned to, -1 = any
+    bool    tick_high_priority  = false; // raise the worker's priority, opt-in
+
     std::string category = "";
 
     std::string heading_color = "";
@@ -46,7 +101,7 @@ export struct Settings_s {
     std::string total_color         = "";
     std::string total_time_color    = "";
 
-    std::vector<std::pair<std::string, std::string>> splits = {{"", ""}};
+    std::vector<SplitSetting_s> splits = { SplitSetting_s{} };
 
 } settings;
 
@@ -123,6 +178,47 @@ bool isValidHexColor(const std::string& color) {
 
 }
 
+bool isValidSeconds(const std::string& value) {
+
+    static const std::regex pattern("^[0-9]{1,4}$");
+    return std::regex_match(value, pattern) && std::stoi(value) > 0;
+
+}
+
+bool isValidRate(const std::string& value) {
+
+    static const std::regex pattern("^[0-9]{1,5}$");
+    return std::regex_match(value, pattern) && std::stoi(value) > 0;
+
+}
+
+bool isValidDisplayRate(const std::string& value) {
+
+    static const std::regex pattern("^(AUTO|[0-9]{2,3})$");
+    return std::regex_match(value, pattern) && (value == "AUTO" || (std::stoi(value) >= 10 && std::stoi(value) <= 240));
+
+}
+
+bool isValidMicroseconds(const std::string& value) {
+
+    static const std::regex pattern("^[0-9]{1,5}$");
+    return std::regex_match(value, pattern);
+
+}
+
+bool isValidPort(const std::string& value) {
+
+    static const std::regex pattern("^(OFF|[0-9]{4,5})$");
+    return std::regex_match(value, pattern) && (value == "OFF" || (std::stoi(value) >= 1024 && std::stoi(value) <= 65535));
+
+}
+
+bool isValidCpu(const std::string& value) {
+
+    static const std::regex pattern("^(OFF|[0-9]{1,3})$");
+    return std::regex_match(value, pattern);
+
+}
 
 export std::string loadSettings() {
 
@@ -186,10 +282,9 @@ export void setupSettings(std::string settingsStr) {
         if (std::getline(rowStream, name, '=') &&
             std::getline(rowStream, time)) {
 
-            settings.splits.emplace_back(
-                trim(name),
-                trim(time)
-            );
+            SplitSetting_s split{ trim(name), trim(time), std::nullopt };
+            if (Duration target; parseDuration(split.time, target)) split.target = target;
+            settings.splits.push_back(std::move(split));
         } else validSettings = false;
 
     }
@@ -229,6 +324,57 @@ export void setupSettings(std::string settingsStr) {
 
                 settings.two_decimal_points = (value == "ON");
 
+            } else if (key == "display_rate") {
+
+                if (isValidDisplayRate(value)) settings.display_rate = value == "AUTO" ? 0 : std::stoi(value);
+                else validSettings = false;
+
+            } else if (key == "record_trace") {
+
+                settings.record_trace = (value == "ON");
+
+            } else if (key == "perf_trace") {
+
+                settings.perf_trace = (value == "ON");
+
+            } else if (key == "shared_memory") {
+
+                settings.shared_memory = (value == "ON");
+
+            } else if (key == "state_server_port") {
+
+                if (isValidPort(value)) settings.state_server_port = value == "OFF" ? 0 : std::stoi(value);
+                else validSettings = false;
+
+            } else if (key == "trace_ring_seconds") {
+
+                if (isValidSeconds(value)) settings.trace_ring_seconds = std::stoi(value);
+                else validSettings = false;
+
+            } else if (key == "poll_rate_ceiling") {
+
+                if (isValidRate(value)) settings.poll_rate_ceiling = std::stoi(value);
+                else validSettings = false;
+
+            } else if (key == "poll_rate_floor") {
+
+                if (isValidRate(value)) settings.poll_rate_floor = std::stoi(value);
+                else validSettings = false;
+
+            } else if (key == "tick_spin_us") {
+
+                if (isValidMicroseconds(value)) settings.tick_spin_us = std::stoi(value);
+                else validSettings = false;
+
+            } else if (key == "tick_cpu") {
+
+                if (isValidCpu(value)) settings.tick_cpu = value == "OFF" ? -1 : std::stoi(value);
+                else validSettings = false;
+
+            } else if (key == "tick_high_priority") {
+
+                settings.tick_high_priority = (value == "ON");
+
             } else if (key == "timer_start_split") {
 
                 if (KEY_MAP.find(value) != KEY_MAP.end()) settings.timer_start_split = KEY_MAP.at(value);
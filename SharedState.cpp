@@ -0,0 +1,142 @@
+module;
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+
+#include "nxtimer_shm.h"
+
+export module SharedState;
+
+import TimerEngine;
+
+// Writer side of nxtimer_shm.h: the layout and the protocol are described there, the reader is nxtimer_shm.c.
+
+static_assert(offsetof(nxtimer_shm, state_sequence) == 64);
+static_assert(offsetof(nxtimer_shm, state) == 128);
+static_assert(offsetof(nxtimer_shm, event_head) == 192);
+static_assert(offsetof(nxtimer_shm, events) == 256);
+static_assert(sizeof(nxtimer_state) % sizeof(uint64_t) == 0 && sizeof(nxtimer_event) % sizeof(uint64_t) == 0);
+static_assert(sizeof(nxtimer_shm) <= NXTIMER_SHM_SIZE);
+static_assert(int{EVENT_START} == NXTIMER_EVENT_START && int{EVENT_FINAL} == NXTIMER_EVENT_FINAL);
+
+export class SharedStateWriter {
+
+public:
+
+    // Creates the segment, or takes over the one a previous run left, and starts a new session.
+    // False if the OS wouldn't give it to us; publish() then does nothing.
+    bool open() {
+
+#ifdef _WIN32
+        HANDLE mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0, NXTIMER_SHM_SIZE, NXTIMER_SHM_NAME);
+        if (!mapping) return false;
+        void* view = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, NXTIMER_SHM_SIZE);
+        if (!view) {
+            CloseHandle(mapping);
+            return false;
+        }
+        handle = mapping; // kept open for the life of the process, the mapping goes away with the last handle
+#else
+        const int fd = shm_open(NXTIMER_SHM_NAME, O_CREAT | O_RDWR, 0600);
+        if (fd < 0) return false;
+        void* view = ftruncate(fd, NXTIMER_SHM_SIZE) == 0 ? mmap(nullptr, NXTIMER_SHM_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+        close(fd);
+        if (view == MAP_FAILED) return false;
+#endif
+
+        shm = static_cast<nxtimer_shm*>(view);
+
+        // Readers still mapped from a previous run see the magic go, then a new session: they drop their
+        // event cursors and start over. The head is reset before the session changes, so a reader that
+        // sees the new session never sees the old head with it.
+        std::atomic_ref(shm->magic).store(0, std::memory_order_relaxed);
+        for (nxtimer_event& slot : shm->events) std::atomic_ref(slot.stamp).store(0, std::memory_order_relaxed);
+        std::atomic_ref(shm->event_head).store(0, std::memory_order_relaxed);
+        eventHead = 0;
+        sequence = std::atomic_ref(shm->state_sequence).load(std::memory_order_relaxed) & ~uint64_t{1};
+
+        shm->version        = NXTIMER_SHM_VERSION;
+        shm->size           = sizeof(nxtimer_shm);
+        shm->event_capacity = NXTIMER_SHM_EVENTS;
+
+        const uint64_t session = static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+        std::atomic_ref(shm->session).store(session, std::memory_order_release);
+        std::atomic_ref(shm->magic).store(NXTIMER_SHM_MAGIC, std::memory_order_release);
+
+        return true;
+
+    }
+
+    bool isOpen() const { return shm != nullptr; }
+
+    // Events first, so a reader that sees the new state can already find the events that led to it
+    inline void publish(const nxtimer_state& state, const TimerEvent_s* events, size_t eventCount) {
+
+        if (!shm) return;
+
+        for (size_t i = 0; i < eventCount; ++i) {
+
+            const TimerEvent_s& e = events[i];
+            const nxtimer_event value = { eventHead + 1, e.splitIndex, e.timeNs, e.timestampNs, e.errorNs, e.kind, 0 };
+
+            nxtimer_event& slot = shm->events[eventHead % NXTIMER_SHM_EVENTS];
+            std::atomic_ref(slot.stamp).store(0, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            storeWords(slot, value, 1); // all but the stamp
+            std::atomic_ref(slot.stamp).store(value.stamp, std::memory_order_release);
+
+            ++eventHead;
+
+        }
+        if (eventCount) std::atomic_ref(shm->event_head).store(eventHead, std::memory_order_release);
+
+        // the same seqlock as SeqLock::publish, on the segment's words
+        std::atomic_ref(shm->state_sequence).store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        storeWords(shm->state, state);
+        sequence += 2;
+        std::atomic_ref(shm->state_sequence).store(sequence, std::memory_order_release);
+
+    }
+
+private:
+
+    // 'value' into the segment at 'dst' as relaxed atomic words, from word 'first' on
+    template <typename T>
+    static inline void storeWords(T& dst, const T& value, size_t first = 0) {
+
+        uint64_t words[sizeof(T) / sizeof(uint64_t)];
+        std::memcpy(words, &value, sizeof(T));
+
+        uint64_t* to = reinterpret_cast<uint64_t*>(&dst);
+        for (size_t i = first; i < std::size(words); ++i) std::atomic_ref(to[i]).store(words[i], std::memory_order_relaxed);
+
+    }
+
+    nxtimer_shm*    shm         = nullptr;
+    uint64_t        eventHead   = 0;
+    uint64_t        sequence    = 0;    // even, the writer's copy of state_sequence
+#ifdef _WIN32
+    HANDLE          handle      = nullptr;
+#endif
+
+};
+
+// Removes the segment's name, so no new reader finds it once the timer is gone. Mapped readers keep
+// what they have. Windows removes the mapping by itself with the last handle.
+export void unlinkSharedState() {
+#ifndef _WIN32
+    shm_unlink(NXTIMER_SHM_NAME);
+#endif
+}
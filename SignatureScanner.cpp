@@ -0,0 +1,402 @@
+module;
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <future>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cctype>
+#include <bit>
+#include <utility>
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#include <immintrin.h>
+#define NX_SCAN_X86 1
+#endif
+
+export module SignatureScanner;
+
+import MemorySource;
+
+// A byte pattern ("AOB") that locates one watched field inside a module image.
+//
+// Text form, one per line of Signatures.txt:   field: module | A0 ** ** ** ** 84 C0 ?? 75 [+ 0x1C];
+//   hex byte  must match
+//   ??        any byte
+//   **        any byte, and part of the captured little-endian absolute address
+//   + 0x1C    optional addend for fields that sit behind the referenced address
+export struct Signature_s {
+
+    std::string             field;
+    std::string             module;
+    std::vector<uint8_t>    bytes;
+    std::vector<uint8_t>    mask;           // 0xFF where the byte has to match
+    size_t                  captureAt   = 0;
+    size_t                  captureLen  = 0;
+    uintptr_t               addend      = 0;
+    size_t                  anchor      = 0; // first fixed byte, used for the SIMD prefilter
+
+};
+
+export struct ScanModule_s {
+
+    std::string name;
+    uintptr_t   base = 0;
+    size_t      size = 0;
+
+};
+
+// field -> offset relative to the base of its module
+export using FieldOffsets = std::unordered_map<std::string, uintptr_t>;
+
+export bool parseSignature(const std::string& line, Signature_s& out) {
+
+    const size_t colon = line.find(':');
+    const size_t bar   = line.find('|');
+    if (colon == std::string::npos || bar == std::string::npos || bar < colon) return false;
+
+    auto trim = [](std::string s) {
+        s.erase(0, s.find_first_not_of(" \t\r\n"));
+        s.erase(s.find_last_not_of(" \t\r\n") + 1);
+        return s;
+    };
+
+    out = Signature_s{};
+    out.field  = trim(line.substr(0, colon));
+    out.module = trim(line.substr(colon + 1, bar - colon - 1));
+
+    std::string body = line.substr(bar + 1);
+    const size_t plus = body.find('+');
+    if (plus != std::string::npos) {
+        try { out.addend = static_cast<uintptr_t>(std::stoull(trim(body.substr(plus + 1)), nullptr, 16)); }
+        catch (...) { return false; }
+        body = body.substr(0, plus);
+    }
+
+    std::istringstream tokens(body);
+    std::string tok;
+    bool inCapture = false;
+    bool captureDone = false;
+
+    while (tokens >> tok) {
+
+        if (tok == "**") {
+
+            if (captureDone) return false; // only one capture per signature
+            if (!inCapture) out.captureAt = out.bytes.size();
+            inCapture = true;
+            out.captureLen++;
+            out.bytes.push_back(0);
+            out.mask.push_back(0);
+            continue;
+
+        }
+
+        if (inCapture) captureDone = true;
+        inCapture = false;
+
+        if (tok == "??") {
+            out.bytes.push_back(0);
+            out.mask.push_back(0);
+        } else if (tok.size() == 2 && std::isxdigit(static_cast<unsigned char>(tok[0])) &&
+                                      std::isxdigit(static_cast<unsigned char>(tok[1]))) {
+            out.bytes.push_back(static_cast<uint8_t>(std::stoul(tok, nullptr, 16)));
+            out.mask.push_back(0xFF);
+        } else return false;
+
+    }
+
+    const auto fixed = std::find(out.mask.begin(), out.mask.end(), 0xFF);
+    if (fixed == out.mask.end() || out.captureLen == 0 || out.captureLen > sizeof(uintptr_t)) return false;
+
+    out.anchor = static_cast<size_t>(fixed - out.mask.begin());
+    return !out.field.empty() && !out.module.empty();
+
+}
+
+export std::vector<Signature_s> loadSignatures(const std::string& path) {
+
+    std::vector<Signature_s> result;
+    std::ifstream file(path);
+    std::string line;
+
+    while (std::getline(file, line, ';')) {
+
+        Signature_s sig;
+        if (!parseSignature(line, sig)) continue;
+
+        // a later line for a field replaces the earlier one, so each field is scanned in one module only
+        const auto same = std::find_if(result.begin(), result.end(), [&](const Signature_s& s) { return s.field == sig.field; });
+        if (same != result.end()) *same = std::move(sig);
+        else result.push_back(std::move(sig));
+
+    }
+
+    return result;
+
+}
+
+static bool matchesAt(const uint8_t* p, const Signature_s& sig) {
+
+    for (size_t i = 0; i < sig.bytes.size(); ++i) {
+        if ((p[i] ^ sig.bytes[i]) & sig.mask[i]) return false;
+    }
+    return true;
+
+}
+
+// All scanners return the position of the first match in [from, last], or SIZE_MAX
+static size_t findScalar(const uint8_t* data, size_t from, size_t last, const Signature_s& sig) {
+
+    const uint8_t a = sig.bytes[sig.anchor];
+
+    for (size_t i = from; i <= last; ++i) {
+        const void* hit = std::memchr(data + i + sig.anchor, a, last - i + 1);
+        if (!hit) return SIZE_MAX;
+        i = static_cast<size_t>(static_cast<const uint8_t*>(hit) - data) - sig.anchor;
+        if (matchesAt(data + i, sig)) return i;
+    }
+    return SIZE_MAX;
+
+}
+
+#ifdef NX_SCAN_X86
+
+// Compare 16 candidate anchor bytes at once, then verify the full pattern only where they hit
+static size_t findSse2(const uint8_t* data, size_t from, size_t last, const Signature_s& sig) {
+
+    const __m128i needle = _mm_set1_epi8(static_cast<char>(sig.bytes[sig.anchor]));
+    size_t i = from;
+
+    for (; i + 16 <= last + 1; i += 16) {
+
+        const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + sig.anchor));
+        unsigned bits = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, needle)));
+
+        while (bits) {
+            const unsigned bit = static_cast<unsigned>(std::countr_zero(bits));
+            if (matchesAt(data + i + bit, sig)) return i + bit;
+            bits &= bits - 1;
+        }
+
+    }
+
+    return i <= last ? findScalar(data, i, last, sig) : SIZE_MAX;
+
+}
+
+#if defined(__GNUC__)
+__attribute__((target("avx2")))
+static size_t findAvx2(const uint8_t* data, size_t from, size_t last, const Signature_s& sig) {
+
+    const __m256i needle = _mm256_set1_epi8(static_cast<char>(sig.bytes[sig.anchor]));
+    size_t i = from;
+
+    for (; i + 32 <= last + 1; i += 32) {
+
+        const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + sig.anchor));
+        unsigned bits = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, needle)));
+
+        while (bits) {
+            const unsigned bit = static_cast<unsigned>(std::countr_zero(bits));
+            if (matchesAt(data + i + bit, sig)) return i + bit;
+            bits &= bits - 1;
+        }
+
+    }
+
+    return i <= last ? findSse2(data, i, last, sig) : SIZE_MAX;
+
+}
+#endif
+
+#endif
+
+static size_t findPattern(const uint8_t* data, size_t size, size_t from, const Signature_s& sig) {
+
+    if (sig.bytes.empty() || size < sig.bytes.size()) return SIZE_MAX;
+    const size_t last = size - sig.bytes.size();
+    if (from > last) return SIZE_MAX;
+
+#ifdef NX_SCAN_X86
+#if defined(__GNUC__)
+    static const bool hasAvx2 = __builtin_cpu_supports("avx2");
+    if (hasAvx2) return findAvx2(data, from, last, sig);
+#endif
+    return findSse2(data, from, last, sig);
+#else
+    return findScalar(data, from, last, sig);
+#endif
+
+}
+
+// Returns the module-relative offset a signature points at, or 0 if it matches zero or several times
+// or the address it captures lies outside the module
+export uintptr_t resolveSignature(const uint8_t* image, size_t size, uintptr_t moduleBase, const Signature_s& sig) {
+
+    const size_t hit = findPattern(image, size, 0, sig);
+    if (hit == SIZE_MAX) return 0;
+    if (findPattern(image, size, hit + 1, sig) != SIZE_MAX) return 0; // ambiguous, don't guess
+
+    uintptr_t absolute = 0;
+    std::memcpy(&absolute, image + hit + sig.captureAt, sig.captureLen); // little endian target
+    absolute += sig.addend;
+
+    return absolute > moduleBase && absolute - moduleBase < size ? absolute - moduleBase : 0;
+
+}
+
+// Copies a whole module image out of the target. Unreadable pages (guard pages, discarded
+// sections) are left zeroed, the scatter list makes that a single call on Linux.
+static std::vector<uint8_t> readModuleImage(MemorySource& source, const ScanModule_s& mod) {
+
+    constexpr size_t kChunk = 0x10000;
+
+    std::vector<uint8_t> image(mod.size, 0);
+    std::vector<ReadRequest_s> reads;
+    reads.reserve(mod.size / kChunk + 1);
+
+    for (size_t off = 0; off < mod.size; off += kChunk) {
+        reads.push_back({ mod.base + off, std::min(kChunk, mod.size - off), image.data() + off });
+    }
+
+    source.readScatter(reads.data(), reads.size());
+    return image;
+
+}
+
+// Identity of a module build: FNV-1a over its PE headers (timestamp, checksum, section table).
+// Only the first page is hashed, the rest of the image changes while the game runs.
+export uint64_t hashModule(MemorySource& source, const ScanModule_s& mod) {
+
+    uint8_t header[0x1000] = {0};
+    if (!source.read(mod.base, header, std::min(sizeof(header), mod.size))) return 0;
+
+    uint64_t h = 1469598103934665603ull;
+    for (uint8_t b : header) {
+        h ^= b;
+        h *= 1099511628211ull;
+    }
+    return h ^ mod.size;
+
+}
+
+// FNV-1a over everything that decides where a signature resolves, so editing a line in
+// Signatures.txt misses the cache instead of returning what the old pattern found
+static uint64_t hashSignature(const Signature_s& sig) {
+
+    uint64_t h = 1469598103934665603ull;
+    auto mix = [&h](const void* data, size_t size) {
+        for (size_t i = 0; i < size; ++i) {
+            h ^= static_cast<const uint8_t*>(data)[i];
+            h *= 1099511628211ull;
+        }
+    };
+
+    const uint64_t numbers[] = { sig.captureAt, sig.captureLen, sig.addend, sig.bytes.size() };
+    mix(sig.module.data(), sig.module.size());
+    mix(sig.bytes.data(), sig.bytes.size());
+    mix(sig.mask.data(), sig.mask.size());
+    mix(numbers, sizeof(numbers));
+    return h;
+
+}
+
+static std::string cacheKey(uint64_t moduleHash, const Signature_s& sig) {
+
+    std::ostringstream key;
+    key << std::hex << moduleHash << ':' << hashSignature(sig) << ':' << sig.field;
+    return key.str();
+
+}
+
+static std::unordered_map<std::string, uintptr_t> loadCache(const std::string& path) {
+
+    std::unordered_map<std::string, uintptr_t> cache;
+    std::ifstream file(path);
+    std::string key, value;
+
+    while (file >> key >> value) {
+        try { cache[key] = static_cast<uintptr_t>(std::stoull(value, nullptr, 16)); }
+        catch (...) {}
+    }
+    return cache;
+
+}
+
+// Locates every signature in its module. Results are cached in 'cachePath' keyed by module and
+// signature hash, so a build that was scanned once resolves from a few header reads on later startups.
+// Each module is scanned on its own thread.
+export FieldOffsets scanSignatures(MemorySource& source,
+                                   const std::vector<ScanModule_s>& modules,
+                                   const std::vector<Signature_s>& signatures,
+                                   const std::string& cachePath) {
+
+    FieldOffsets found;
+    auto cache = loadCache(cachePath);
+
+    std::unordered_map<std::string, uint64_t> hashes;
+    for (const auto& mod : modules) hashes[mod.name] = hashModule(source, mod);
+
+    std::vector<const ScanModule_s*> toScan;
+
+    for (const auto& sig : signatures) {
+
+        const auto h = hashes.find(sig.module);
+        if (h == hashes.end() || !h->second) continue;
+
+        const auto cached = cache.find(cacheKey(h->second, sig));
+        const auto mod = std::find_if(modules.begin(), modules.end(), [&](const ScanModule_s& m) { return m.name == sig.module; });
+        if (cached != cache.end() && cached->second && cached->second < mod->size) {
+            found[sig.field] = cached->second;
+            continue;
+        }
+
+        if (std::find(toScan.begin(), toScan.end(), &*mod) == toScan.end()) toScan.push_back(&*mod);
+
+    }
+
+    if (toScan.empty()) return found;
+
+    // MemorySource isn't thread safe, so images are copied out first and only the scans run in parallel
+    std::vector<std::vector<uint8_t>> images;
+    images.reserve(toScan.size());
+    for (const auto* mod : toScan) images.push_back(readModuleImage(source, *mod));
+
+    const FieldOffsets fromCache = found;
+
+    // only offsets resolveSignature verified come back, so only those reach the cache
+    std::vector<std::future<std::vector<std::pair<const Signature_s*, uintptr_t>>>> jobs;
+    for (size_t m = 0; m < toScan.size(); ++m) {
+
+        jobs.push_back(std::async(std::launch::async, [&, m] {
+
+            std::vector<std::pair<const Signature_s*, uintptr_t>> local;
+            for (const auto& sig : signatures) {
+                if (sig.module != toScan[m]->name || fromCache.count(sig.field)) continue;
+                const uintptr_t off = resolveSignature(images[m].data(), images[m].size(), toScan[m]->base, sig);
+                if (off) local.emplace_back(&sig, off);
+            }
+            return local;
+
+        }));
+
+    }
+
+    std::ofstream out(cachePath, std::ios::app);
+    for (size_t m = 0; m < jobs.size(); ++m) {
+
+        for (const auto& [sig, off] : jobs[m].get()) {
+            found[sig->field] = off;
+            out << cacheKey(hashes[toScan[m]->name], *sig) << ' ' << std::hex << off << '\n';
+        }
+
+    }
+
+    return found;
+
+}
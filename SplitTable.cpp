@@ -0,0 +1,239 @@
+module;
+
+#include <QWidget>
+#include <QPainter>
+#include <QPaintEvent>
+#include <QResizeEvent>
+#include <QStaticText>
+#include <QFont>
+#include <QFontMetrics>
+#include <QColor>
+#include <QString>
+#include <QRect>
+#include <QSize>
+#include <QSizePolicy>
+#include <functional>
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+export module SplitTable;
+
+import TimerDisplay;
+
+// What one row of the split table shows: the split's name, then "(delta)" and its time right-aligned
+export struct SplitRow_s {
+
+    QString name;
+    QString time;
+    QString delta;
+    QRgb    deltaColor  = 0;
+
+    bool operator==(const SplitRow_s&) const = default;
+
+};
+
+// Every split of the category, however many. The view is told which rows changed, a setRow() that
+// changes nothing tells it nothing.
+export class SplitTableModel {
+
+public:
+
+    using Listener = std::function<void(size_t first, size_t last)>; // rows first..last changed
+
+    void assign(std::vector<SplitRow_s> newRows) {
+
+        rows = std::move(newRows);
+        if (!rows.empty()) notify(0, rows.size() - 1);
+
+    }
+
+    void setRow(size_t i, SplitRow_s row) {
+
+        if (i >= rows.size() || rows[i] == row) return;
+        rows[i] = std::move(row);
+        notify(i, i);
+
+    }
+
+    size_t size() const { return rows.size(); }
+    const SplitRow_s& row(size_t i) const { return rows[i]; }
+
+    void setListener(Listener l) { listener = std::move(l); }
+
+private:
+
+    void notify(size_t first, size_t last) {
+        if (listener) listener(first, last);
+    }
+
+    std::vector<SplitRow_s> rows;
+    Listener                listener;
+
+};
+
+// A window of rows onto a SplitTableModel, painted as one widget. Each visible row keeps its laid out
+// name and glyphs in a slot, and the slots form a ring: scrolling rotates the ring and lays out only
+// the rows that came into view, a model change lays out and repaints only its own row.
+export class SplitTableView : public QWidget {
+
+public:
+
+    SplitTableView(SplitTableModel& model, GlyphAtlas& glyphs, const QFont& nameFont, QRgb nameColor, QRgb timeColor,
+                   size_t visibleRows, int rowSpacing, QWidget* parent = nullptr)
+        : QWidget(parent), model(model), glyphs(glyphs), nameFont(nameFont), nameMetrics(nameFont),
+          nameColor(nameColor), timeColor(timeColor), slots(std::max<size_t>(visibleRows, 1)), rowSpacing(rowSpacing) {
+
+        deltaColumn = glyphs.width("(-0:00.000)");
+        gapColumn   = glyphs.width("  ");
+        timeColumn  = glyphs.width("0:00.000");
+        rowHeight   = std::max(glyphs.height(), nameMetrics.height());
+
+        setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
+        model.setListener([this](size_t first, size_t last) { rowsChanged(first, last); });
+        relayoutAll();
+
+    }
+
+    QSize sizeHint() const override {
+        return QSize(deltaColumn + gapColumn + timeColumn, static_cast<int>(slots.size()) * rowPitch() - rowSpacing);
+    }
+    QSize minimumSizeHint() const override { return sizeHint(); }
+
+    size_t top() const { return first; }
+
+    // Scrolls so 'row' is the top row, as far as the model allows
+    void setTop(size_t row) {
+
+        const size_t last = model.size() > slots.size() ? model.size() - slots.size() : 0;
+        row = std::min(row, last);
+        if (row == first) return;
+
+        const size_t n = slots.size();
+        const size_t shift = row > first ? row - first : first - row;
+
+        if (shift >= n) {
+            first = row;
+            relayoutAll();
+            return;
+        }
+
+        if (row > first) {
+            // slots that scrolled off the top come back at the bottom with the rows that came into view
+            ringStart = (ringStart + shift) % n;
+            first = row;
+            for (size_t k = n - shift; k < n; ++k) layoutSlot(k);
+        } else {
+            ringStart = (ringStart + n - shift) % n;
+            first = row;
+            for (size_t k = 0; k < shift; ++k) layoutSlot(k);
+        }
+
+        // every row moved, and with the window's background showing through this can't be a blit
+        update();
+
+    }
+
+protected:
+
+    void paintEvent(QPaintEvent* event) override {
+
+        QPainter painter(this);
+
+        for (size_t k = 0; k < slots.size(); ++k) {
+
+            const QRect r = rowRect(k);
+            if (!event->rect().intersects(r)) continue;
+
+            const Slot_s& s = slotAt(k);
+            if (s.row >= model.size()) continue;
+
+            painter.setFont(nameFont);
+            painter.setPen(QColor::fromRgba(nameColor));
+            painter.drawStaticText(0, r.top() + (rowHeight - nameMetrics.height()) / 2, s.name);
+
+            const int glyphTop = r.top() + (rowHeight - glyphs.height()) / 2;
+            for (const GlyphCell_s& c : s.cells) glyphs.draw(painter, c.x, glyphTop, c.ch, c.color);
+
+        }
+
+    }
+
+    void resizeEvent(QResizeEvent*) override {
+        relayoutAll();
+    }
+
+private:
+
+    struct Slot_s {
+
+        size_t                      row     = SIZE_MAX;
+        QStaticText                 name;
+        std::vector<GlyphCell_s>    cells;  // right to left
+
+    };
+
+    int rowPitch() const { return rowHeight + rowSpacing; }
+    QRect rowRect(size_t k) const { return QRect(0, static_cast<int>(k) * rowPitch(), width(), rowHeight); }
+
+    // k-th visible row, counted from the top
+    Slot_s& slotAt(size_t k) { return slots[(ringStart + k) % slots.size()]; }
+
+    void layoutSlot(size_t k) {
+
+        Slot_s& s = slotAt(k);
+        s.row = first + k;
+        s.cells.clear();
+        if (s.row >= model.size()) return;
+
+        const SplitRow_s& r = model.row(s.row);
+        const GlyphRun_s runs[] = {
+            { r.delta, r.deltaColor, deltaColumn },
+            { QString(), 0, gapColumn },
+            { r.time, timeColor, timeColumn },
+        };
+        const int left = layoutGlyphRuns(glyphs, runs, width(), s.cells);
+
+        // long names are cut short rather than run into the times
+        s.name.setTextFormat(Qt::PlainText);
+        s.name.setText(nameMetrics.elidedText(r.name, Qt::ElideRight, std::max(0, left - gapColumn)));
+
+    }
+
+    void relayoutAll() {
+
+        for (size_t k = 0; k < slots.size(); ++k) layoutSlot(k);
+        update();
+
+    }
+
+    void rowsChanged(size_t firstRow, size_t lastRow) {
+
+        for (size_t k = 0; k < slots.size(); ++k) {
+            const size_t row = first + k;
+            if (row < firstRow || row > lastRow) continue;
+            layoutSlot(k);
+            update(rowRect(k));
+        }
+
+    }
+
+    SplitTableModel&        model;
+    GlyphAtlas&             glyphs;
+    QFont                   nameFont;
+    QFontMetrics            nameMetrics;
+    QRgb                    nameColor;
+    QRgb                    timeColor;
+
+    std::vector<Slot_s>     slots;
+    size_t                  ringStart   = 0;    // slot of the top row
+    size_t                  first       = 0;    // model row shown at the top
+
+    int                     rowSpacing  = 0;
+    int                     rowHeight   = 0;
+    int                     deltaColumn = 0;
+    int                     gapColumn   = 0;
+    int                     timeColumn  = 0;
+
+};
@@ -0,0 +1,69 @@
+module;
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+export module SpscQueue;
+
+// Bounded lock-free ring for exactly one producer thread and one consumer thread.
+// Each side owns one index and only reads the other's, so a push or pop is two loads and a store.
+export template <typename T, size_t Capacity>
+class SpscQueue {
+
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+    static_assert(std::is_trivially_copyable_v<T>);
+
+public:
+
+    // producer only, false (and the item is dropped) when the consumer fell a full ring behind
+    bool push(const T& item) {
+
+        const size_t h = head.load(std::memory_order_relaxed);
+        if (h - cachedTail == Capacity) {
+            cachedTail = tail.load(std::memory_order_acquire);
+            if (h - cachedTail == Capacity) {
+                dropped.store(dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                return false;
+            }
+        }
+
+        slots[h & (Capacity - 1)] = item;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+
+    }
+
+    // consumer only
+    bool pop(T& out) {
+
+        const size_t t = tail.load(std::memory_order_relaxed);
+        if (t == cachedHead) {
+            cachedHead = head.load(std::memory_order_acquire);
+            if (t == cachedHead) return false;
+        }
+
+        out = slots[t & (Capacity - 1)];
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+
+    }
+
+    // items the producer had to throw away so far
+    uint64_t droppedCount() const { return dropped.load(std::memory_order_relaxed); }
+
+private:
+
+    // producer side
+    alignas(64) std::atomic<size_t> head{0};
+    size_t cachedTail = 0;
+    std::atomic<uint64_t> dropped{0};
+
+    // consumer side
+    alignas(64) std::atomic<size_t> tail{0};
+    size_t cachedHead = 0;
+
+    alignas(64) T slots[Capacity] = {};
+
+};
@@ -0,0 +1,383 @@
+module;
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <algorithm>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+
+export module StateServer;
+
+import TimerWorker;
+import PerfTracer;
+
+// Timer state for browser-source overlays, over Server-Sent Events on 127.0.0.1:
+//
+//   GET /events   text/event-stream: the full state on connect, then "timer" events in the order the
+//                 worker emitted them and "state" messages with only the fields that changed
+//   GET /state    the full state once, as JSON
+//
+// The server has its own thread. The worker only pushes its events into a second ring next to the
+// GUI's and publishes its snapshot as before, so a stalled or crowded server never delays a tick.
+// Everything that came in during one flush interval goes out as one write per client, with the
+// state coalesced to its latest value; clients that stop reading are dropped, not waited for.
+
+#ifdef _WIN32
+using Socket = SOCKET;
+static constexpr Socket kNoSocket = INVALID_SOCKET;
+static constexpr int kSendFlags = 0;
+static int pollSockets(pollfd* fds, size_t n, int timeoutMs) { return WSAPoll(fds, static_cast<ULONG>(n), timeoutMs); }
+static void closeSocket(Socket s) { closesocket(s); }
+static bool setNonBlocking(Socket s) { u_long on = 1; return ioctlsocket(s, FIONBIO, &on) == 0; }
+static bool wouldBlock() { return WSAGetLastError() == WSAEWOULDBLOCK; }
+#else
+using Socket = int;
+static constexpr Socket kNoSocket = -1;
+static constexpr int kSendFlags = MSG_NOSIGNAL; // a client that went away is an error, not a SIGPIPE
+static int pollSockets(pollfd* fds, size_t n, int timeoutMs) { return poll(fds, static_cast<nfds_t>(n), timeoutMs); }
+static void closeSocket(Socket s) { close(s); }
+static bool setNonBlocking(Socket s) { return fcntl(s, F_SETFL, fcntl(s, F_GETFL, 0) | O_NONBLOCK) == 0; }
+static bool wouldBlock() { return errno == EAGAIN || errno == EWOULDBLOCK; }
+#endif
+
+static constexpr auto     kFlushInterval  = std::chrono::milliseconds(50);   // 20 state updates a second while the time counts
+static constexpr auto     kKeepAlive      = std::chrono::seconds(15);        // a comment line, so proxies and OBS keep the stream open
+static constexpr size_t   kMaxClients     = 64;
+static constexpr size_t   kMaxRequest     = 4096;                            // bytes of request head before giving up on a client
+static constexpr size_t   kMaxBacklog     = 256 * 1024;                      // unsent bytes before a client counts as gone
+
+export class StateServer {
+
+public:
+
+    // Listens on 127.0.0.1:port, false if the port can't be had
+    bool open(uint16_t port) {
+
+#ifdef _WIN32
+        WSADATA wsa;
+        if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) return false;
+#endif
+
+        listener = socket(AF_INET, SOCK_STREAM, 0);
+        if (listener == kNoSocket) return false;
+
+#ifndef _WIN32
+        // restarting the timer shouldn't have to wait out the old socket's TIME_WAIT
+        const int on = 1;
+        setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+#endif
+
+        sockaddr_in address = {};
+        address.sin_family      = AF_INET;
+        address.sin_port        = htons(port);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+        if (bind(listener, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 ||
+            listen(listener, 16) != 0 || !setNonBlocking(listener)) {
+            closeSocket(listener);
+            listener = kNoSocket;
+            return false;
+        }
+
+        requestServerEvents();
+        running.store(true, std::memory_order_relaxed);
+        return true;
+
+    }
+
+    // Serves until stop(), on the calling thread
+    void run() {
+
+        setPerfThreadName("state server");
+
+        std::vector<pollfd> fds;
+        auto nextFlush = std::chrono::steady_clock::now();
+        auto nextKeepAlive = nextFlush + kKeepAlive;
+
+        while (!stopping.load(std::memory_order_relaxed)) {
+
+            fds.clear();
+            fds.push_back({ listener, POLLIN, 0 });
+            for (const Client_s& c : clients) fds.push_back({ c.socket, static_cast<short>(POLLIN | (c.outbox.empty() ? 0 : POLLOUT)), 0 });
+
+            const auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(nextFlush - std::chrono::steady_clock::now());
+            pollSockets(fds.data(), fds.size(), static_cast<int>(std::clamp<int64_t>(wait.count(), 0, kFlushInterval.count())));
+
+            if (fds[0].revents & POLLIN) acceptClients();
+            for (size_t i = 1; i < fds.size(); ++i) {
+                if (fds[i].revents & (POLLIN | POLLERR | POLLHUP)) receive(clients[i - 1]);
+            }
+
+            const auto now = std::chrono::steady_clock::now();
+            if (now >= nextFlush) {
+                std::string batch = collectBatch();
+                if (batch.empty() && now >= nextKeepAlive) batch = ": keep-alive\n\n";
+                if (!batch.empty()) {
+                    broadcast(batch);
+                    nextKeepAlive = now + kKeepAlive;
+                }
+                nextFlush = now + kFlushInterval;
+            }
+
+            for (Client_s& c : clients) send(c);
+            std::erase_if(clients, [](const Client_s& c) {
+                if (!c.closed && !(c.closeWhenSent && c.outbox.empty())) return false;
+                closeSocket(c.socket);
+                return true;
+            });
+
+        }
+
+        for (const Client_s& c : clients) closeSocket(c.socket);
+        clients.clear();
+        closeSocket(listener);
+        listener = kNoSocket;
+
+        running.store(false, std::memory_order_release);
+        running.notify_all();
+
+    }
+
+    // Any thread, run() returns within one flush interval
+    void stop() {
+        stopping.store(true, std::memory_order_relaxed);
+    }
+
+    // Blocks until run() has returned, right away if the server never opened
+    void waitStopped() {
+        running.wait(true, std::memory_order_acquire);
+    }
+
+private:
+
+    struct Client_s {
+
+        Socket      socket          = kNoSocket;
+        std::string request;                    // until the blank line that ends the head
+        std::string outbox;                     // not yet written
+        bool        streaming       = false;    // on /events, gets every batch
+        bool        closeWhenSent   = false;
+        bool        closed          = false;
+
+    };
+
+    void acceptClients() {
+
+        while (true) {
+
+            const Socket s = accept(listener, nullptr, nullptr);
+            if (s == kNoSocket) return;
+
+            if (clients.size() >= kMaxClients || !setNonBlocking(s)) {
+                closeSocket(s);
+                continue;
+            }
+
+            // batches are already as large as they get, don't let Nagle hold them back
+            const int on = 1;
+            setsockopt(s, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&on), sizeof(on));
+
+            Client_s& c = clients.emplace_back();
+            c.socket = s;
+
+        }
+
+    }
+
+    void receive(Client_s& c) {
+
+        char buffer[1024];
+        while (true) {
+
+            const auto n = recv(c.socket, buffer, sizeof(buffer), 0);
+            if (n == 0 || (n < 0 && !wouldBlock())) {
+                c.closed = true;
+                return;
+            }
+            if (n < 0) break;
+
+            // once answered, whatever else a client sends is ignored
+            if (c.streaming || c.closeWhenSent) continue;
+            c.request.append(buffer, static_cast<size_t>(n));
+            if (c.request.size() > kMaxRequest) break;
+
+        }
+
+        if (c.streaming || c.closeWhenSent) return;
+        if (c.request.find("\r\n\r\n") != std::string::npos) answer(c);
+        else if (c.request.size() > kMaxRequest) reject(c, "431 Request Header Fields Too Large");
+
+    }
+
+    void answer(Client_s& c) {
+
+        const std::string_view request = c.request;
+        if (!request.starts_with("GET ")) return reject(c, "405 Method Not Allowed");
+
+        const size_t end = request.find(' ', 4);
+        std::string_view path = request.substr(4, end == std::string_view::npos ? std::string_view::npos : end - 4);
+        path = path.substr(0, path.find('?'));
+
+        if (path == "/events") {
+            c.outbox = "HTTP/1.1 200 OK\r\n"
+                       "Content-Type: text/event-stream\r\n"
+                       "Cache-Control: no-cache\r\n"
+                       "Connection: keep-alive\r\n"
+                       "Access-Control-Allow-Origin: *\r\n"
+                       "\r\n"
+                       "retry: 1000\n\n";
+            appendStateMessage(c.outbox, sent, nullptr);
+            c.streaming = true;
+        } else if (path == "/state") {
+            std::string body;
+            appendStateJson(body, sent, nullptr);
+            c.outbox = "HTTP/1.1 200 OK\r\n"
+                       "Content-Type: application/json\r\n"
+                       "Cache-Control: no-cache\r\n"
+                       "Access-Control-Allow-Origin: *\r\n"
+                       "Connection: close\r\n"
+                       "Content-Length: " + std::to_string(body.size()) + "\r\n"
+                       "\r\n" + body;
+            c.closeWhenSent = true;
+        } else {
+            return reject(c, "404 Not Found");
+        }
+        c.request.clear();
+        c.request.shrink_to_fit();
+
+    }
+
+    void reject(Client_s& c, const char* status) {
+
+        c.outbox = std::string("HTTP/1.1 ") + status + "\r\nConnection: close\r\nContent-Length: 0\r\n\r\n";
+        c.closeWhenSent = true;
+
+    }
+
+    // Every event since the last flush and the state as it is now, against what clients last got
+    std::string collectBatch() {
+
+        std::string batch;
+
+        TimerEvent_s event;
+        while (popServerEvent(event)) {
+            char text[192];
+            const int n = std::snprintf(text, sizeof(text),
+                                        "event: timer\ndata: {\"event\":\"%s\",\"split\":%zu,\"time_ns\":%" PRId64 ",\"error_ns\":%" PRId64 "}\n\n",
+                                        timerEventName(event.kind), event.splitIndex, event.timeNs, event.errorNs);
+            batch.append(text, static_cast<size_t>(std::clamp(n, 0, static_cast<int>(sizeof(text)) - 1)));
+        }
+
+        // events were lost while this thread was starved: resend the whole state so nothing stays stale
+        const TimerSnapshot_s now = readTimerSnapshot();
+        const bool resync = droppedServerEvents() != seenDropped;
+        seenDropped = droppedServerEvents();
+        appendStateMessage(batch, now, resync ? nullptr : &sent);
+        sent = now;
+
+        return batch;
+
+    }
+
+    void broadcast(const std::string& batch) {
+
+        for (Client_s& c : clients) {
+            if (!c.streaming || c.closed) continue;
+            c.outbox += batch;
+            if (c.outbox.size() > kMaxBacklog) {
+                c.closed = true;
+            }
+        }
+
+    }
+
+    void send(Client_s& c) {
+
+        size_t written = 0;
+        while (written < c.outbox.size() && !c.closed) {
+            const auto n = ::send(c.socket, c.outbox.data() + written, static_cast<int>(c.outbox.size() - written), kSendFlags);
+            if (n > 0) written += static_cast<size_t>(n);
+            else if (n < 0 && wouldBlock()) break;
+            else c.closed = true;
+        }
+        c.outbox.erase(0, written);
+
+    }
+
+    // The fields of 's' that differ from 'before', all of them without one. Nothing if none differ.
+    static void appendStateJson(std::string& out, const TimerSnapshot_s& s, const TimerSnapshot_s* before) {
+
+        const size_t start = out.size();
+        char text[64];
+        const auto field = [&](bool changed, const char* format, auto value) {
+            if (!changed) return;
+            out += out.size() == start ? '{' : ',';
+            const int n = std::snprintf(text, sizeof(text), format, value);
+            out.append(text, static_cast<size_t>(std::clamp(n, 0, static_cast<int>(sizeof(text)) - 1)));
+        };
+
+        field(!before || before->currentSplitIndex != s.currentSplitIndex, "\"split\":%zu", s.currentSplitIndex);
+        field(!before || before->timerRunning != s.timerRunning, "\"running\":%s", s.timerRunning ? "true" : "false");
+        field(!before || before->gameTimePaused != s.gameTimePaused, "\"paused\":%s", s.gameTimePaused ? "true" : "false");
+        field(!before || before->displayTotal != s.displayTotal, "\"finished\":%s", s.displayTotal ? "true" : "false");
+        field(!before || before->accumulatedNs != s.accumulatedNs, "\"time_ns\":%" PRId64, s.accumulatedNs);
+        field(!before || before->errorBoundNs != s.errorBoundNs, "\"error_ns\":%" PRId64, s.errorBoundNs);
+        if (out.size() != start) out += '}';
+
+    }
+
+    static void appendStateMessage(std::string& out, const TimerSnapshot_s& s, const TimerSnapshot_s* before) {
+
+        std::string json;
+        appendStateJson(json, s, before);
+        if (!json.empty()) out += "event: state\ndata: " + json + "\n\n";
+
+    }
+
+    Socket                  listener    = kNoSocket;
+    std::vector<Client_s>   clients;
+    TimerSnapshot_s         sent;       // the state every streaming client has been sent
+    uint64_t                seenDropped = 0;
+    std::atomic<bool>       stopping{false};
+    std::atomic<bool>       running{false};     // open() to the end of run()
+
+};
+
+StateServer stateServer;
+
+// Serves 127.0.0.1:port from a thread of its own. The port is bound before this returns, false if
+// that failed and nothing was started.
+export bool startStateServer(uint16_t port) {
+
+    if (!stateServer.open(port)) return false;
+    std::thread([] { stateServer.run(); }).detach(); // runs until stopStateServer()
+    return true;
+
+}
+
+// Closes every connection and returns once the server's thread is done with them, so exit doesn't
+// destroy the server under it. Does nothing if the server wasn't started.
+export void stopStateServer() {
+
+    stateServer.stop();
+    stateServer.waitStopped();
+
+}
@@ -0,0 +1,266 @@
+module;
+
+#ifdef _WIN32
+#include <windows.h>
+#include <mmsystem.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#include <sys/prctl.h>
+#include <cerrno>
+#include <ctime>
+#endif
+#include <cstdint>
+#include <cstddef>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <string>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+
+export module TickScheduler;
+
+export struct TickSchedulerConfig_s {
+
+    unsigned    spinMicroseconds    = 0;     // sleep until this long before the deadline, then spin; 0 = sleep only
+    int         cpu                 = -1;    // pin the ticking thread to this core, -1 = leave it to the OS
+    bool        highPriority        = false; // raise the ticking thread's priority (real-time scheduling on Linux)
+
+};
+
+// How far past its deadline a tick woke up, in power-of-two microsecond buckets:
+// [0] < 1 us, [1] 1-2 us, [2] 2-4 us ... [kJitterBuckets - 1] everything from ~65 ms up
+export constexpr size_t kJitterBuckets = 18;
+
+export struct TickSchedulerReport_s {
+
+    uint64_t    ticks                   = 0;
+    uint64_t    missed                  = 0;    // deadlines skipped because the loop was already past them
+    double      seconds                 = 0.0;  // time spent ticking (detached time doesn't count)
+    double      achievedHz              = 0.0;
+    uint64_t    jitter[kJitterBuckets]  = {};
+
+};
+
+// Sleeps a thread from one tick deadline to the next as precisely as the OS allows.
+//
+// Windows: a high resolution waitable timer (falls back to a plain one plus timeBeginPeriod(1)).
+// Linux: clock_nanosleep on CLOCK_MONOTONIC with an absolute deadline and 1 ns timer slack.
+// With spinMicroseconds set the last stretch before a deadline is spun instead of slept.
+//
+// A tick that starts after its deadline runs right away and the ticks it ran over are counted as
+// missed rather than caught up, so a stall never turns into a burst of back-to-back reads.
+export class TickScheduler {
+
+public:
+
+    TickScheduler() = default;
+    TickScheduler(const TickScheduler&) = delete;
+    TickScheduler& operator=(const TickScheduler&) = delete;
+
+    ~TickScheduler() { close(); }
+
+    // Call from the thread that will tick: priority and affinity are applied to the calling thread
+    void open(const TickSchedulerConfig_s& cfg) {
+
+        close();
+        config = cfg;
+
+#ifdef _WIN32
+
+        timer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+        if (!timer) {
+            timeBeginPeriod(1);
+            raisedTimerResolution = true;
+            timer = CreateWaitableTimerExW(nullptr, nullptr, 0, TIMER_ALL_ACCESS);
+        }
+
+        if (config.highPriority) SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_HIGHEST);
+        if (config.cpu >= 0 && config.cpu < 64) SetThreadAffinityMask(GetCurrentThread(), uintptr_t{1} << config.cpu);
+
+#else
+
+        prctl(PR_SET_TIMERSLACK, 1UL, 0, 0, 0);
+
+        // SCHED_FIFO needs CAP_SYS_NICE or an rtprio limit, without either the thread just stays SCHED_OTHER
+        if (config.highPriority) {
+            sched_param param{};
+            param.sched_priority = 1;
+            pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+        }
+
+        if (config.cpu >= 0 && config.cpu < CPU_SETSIZE) {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(config.cpu, &set);
+            pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        }
+
+#endif
+
+    }
+
+    void close() {
+
+#ifdef _WIN32
+        if (timer) CloseHandle(timer);
+        timer = nullptr;
+        if (raisedTimerResolution) timeEndPeriod(1);
+        raisedTimerResolution = false;
+#endif
+
+    }
+
+    // Start counting from 'now', e.g. after an attach. Time since the last tick is not ticking time.
+    void restart(std::chrono::steady_clock::time_point now) {
+
+        deadline = now;
+        lastWake = now;
+
+    }
+
+    // Waits for the tick 'interval' after the previous deadline and returns how many ticks were missed
+    uint64_t waitNext(std::chrono::nanoseconds interval) {
+
+        deadline += interval;
+
+        auto now = std::chrono::steady_clock::now();
+        uint64_t missedNow = 0;
+
+        if (now >= deadline) {
+
+            if (interval.count() > 0) missedNow = static_cast<uint64_t>((now - deadline) / interval);
+            add(missed, missedNow);
+
+        } else {
+
+            sleepUntil(deadline);
+            now = std::chrono::steady_clock::now();
+
+        }
+
+        lastLate = now - deadline;
+        add(jitter[bucket(lastLate)], 1);
+        add(ticks, 1);
+        add(tickingNs, std::chrono::duration_cast<std::chrono::nanoseconds>(now - lastWake).count());
+
+        // ran over: the next interval is measured from now, not from the deadline that was missed
+        if (missedNow) deadline = now;
+        lastWake = now;
+
+        return missedNow;
+
+    }
+
+    // How far past its deadline the last waitNext() returned, and when, ticking thread only
+    std::chrono::nanoseconds lastLateness() const {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(lastLate);
+    }
+    std::chrono::steady_clock::time_point lastWakeup() const { return lastWake; }
+
+    // Any thread
+    TickSchedulerReport_s report() const {
+
+        TickSchedulerReport_s r;
+        r.ticks   = ticks.load(std::memory_order_relaxed);
+        r.missed  = missed.load(std::memory_order_relaxed);
+        r.seconds = tickingNs.load(std::memory_order_relaxed) / 1e9;
+        r.achievedHz = r.seconds > 0.0 ? r.ticks / r.seconds : 0.0;
+        for (size_t i = 0; i < kJitterBuckets; ++i) r.jitter[i] = jitter[i].load(std::memory_order_relaxed);
+        return r;
+
+    }
+
+private:
+
+    void sleepUntil(std::chrono::steady_clock::time_point until) {
+
+        const auto spin = std::chrono::microseconds(config.spinMicroseconds);
+        const auto wake = until - spin;
+
+        if (std::chrono::steady_clock::now() < wake) {
+
+#ifdef _WIN32
+
+            if (timer) {
+                // relative due time in 100 ns units, steady_clock and the timer don't share an epoch
+                const auto left = std::chrono::duration_cast<std::chrono::nanoseconds>(wake - std::chrono::steady_clock::now());
+                LARGE_INTEGER due;
+                due.QuadPart = -std::max<LONGLONG>(left.count() / 100, 1);
+                if (SetWaitableTimer(timer, &due, 0, nullptr, nullptr, FALSE)) WaitForSingleObject(timer, INFINITE);
+            } else {
+                std::this_thread::sleep_until(wake);
+            }
+
+#else
+
+            // steady_clock is CLOCK_MONOTONIC on Linux, so the deadline can be passed as is
+            const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(wake.time_since_epoch()).count();
+            timespec ts{ static_cast<time_t>(ns / 1'000'000'000), static_cast<long>(ns % 1'000'000'000) };
+            while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {}
+
+#endif
+
+        }
+
+        while (std::chrono::steady_clock::now() < until) {}
+
+    }
+
+    static size_t bucket(std::chrono::steady_clock::duration late) {
+
+        const auto us = std::chrono::duration_cast<std::chrono::microseconds>(late).count();
+        size_t b = 0;
+        for (auto v = us; v > 0 && b < kJitterBuckets - 1; v >>= 1) ++b;
+        return b;
+
+    }
+
+    // single writer, see TimerWorker's bump()
+    static void add(std::atomic<uint64_t>& counter, uint64_t n) {
+        counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    TickSchedulerConfig_s config;
+
+#ifdef _WIN32
+    HANDLE  timer                   = nullptr;
+    bool    raisedTimerResolution   = false;
+#endif
+
+    std::chrono::steady_clock::time_point deadline;
+    std::chrono::steady_clock::time_point lastWake;
+    std::chrono::steady_clock::duration   lastLate{};
+
+    std::atomic<uint64_t> ticks{0};
+    std::atomic<uint64_t> missed{0};
+    std::atomic<uint64_t> tickingNs{0};
+    std::atomic<uint64_t> jitter[kJitterBuckets] = {};
+
+};
+
+// Plain text version of a report, one line per non-empty jitter bucket
+export std::string formatTickReport(const TickSchedulerReport_s& r) {
+
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(1);
+    out << "ticks: " << r.ticks << ", missed: " << r.missed << "\n"
+        << "achieved rate: " << r.achievedHz << " Hz over " << r.seconds << " s\n"
+        << "wake-up lateness:\n";
+
+    for (size_t i = 0; i < kJitterBuckets; ++i) {
+
+        if (!r.jitter[i]) continue;
+
+        const uint64_t lo = i ? uint64_t{1} << (i - 1) : 0;
+        out << "  " << (i ? std::to_string(lo) : std::string("0")) << " us"
+            << (i + 1 < kJitterBuckets ? " - " + std::to_string(uint64_t{1} << i) + " us" : std::string(" and up"))
+            << ": " << r.jitter[i] << " (" << (100.0 * r.jitter[i] / (r.ticks ? r.ticks : 1)) << "%)\n";
+
+    }
+
+    return out.str();
+
+}
@@ -0,0 +1,319 @@
+module;
+
+#include <cstdint>
+#include <cstddef>
+#include <compare>
+#include <initializer_list>
+#include <span>
+#include <string_view>
+
+export module TimeFormat;
+
+// A length of time in whole nanoseconds, the unit the engine counts game time in. Being fixed point,
+// cutting it to the precision on screen is exact: a double 5.1 s is 5.0999..., which floor(x * 10)
+// turns into "5.0".
+export class Duration {
+
+public:
+
+    static constexpr int64_t kNsPerSecond = 1'000'000'000;
+
+    constexpr Duration() = default;
+
+    static constexpr Duration fromNs(int64_t ns) { Duration d; d.value = ns; return d; }
+    static constexpr Duration fromMs(int64_t ms) { return fromNs(ms * 1'000'000); }
+    static constexpr Duration fromSeconds(int64_t s) { return fromNs(s * kNsPerSecond); }
+
+    constexpr int64_t ns() const { return value; }
+    constexpr double seconds() const { return static_cast<double>(value) / kNsPerSecond; }
+    constexpr bool negative() const { return value < 0; }
+    constexpr Duration abs() const { return fromNs(value < 0 ? -value : value); }
+
+    // Cut (towards zero) to 'precision' decimals of a second
+    constexpr Duration truncated(int precision) const {
+        const int64_t unit = unitOf(precision);
+        return fromNs(value / unit * unit);
+    }
+
+    constexpr Duration operator-() const { return fromNs(-value); }
+    constexpr Duration operator+(Duration other) const { return fromNs(value + other.value); }
+    constexpr Duration operator-(Duration other) const { return fromNs(value - other.value); }
+    constexpr Duration& operator+=(Duration other) { value += other.value; return *this; }
+    constexpr Duration& operator-=(Duration other) { value -= other.value; return *this; }
+
+    constexpr auto operator<=>(const Duration&) const = default;
+
+    // Nanoseconds in one step of the last of 'precision' decimals (0-9)
+    static constexpr int64_t unitOf(int precision) {
+        int64_t unit = kNsPerSecond;
+        for (int i = 0; i < precision && i < 9; ++i) unit /= 10;
+        return unit;
+    }
+
+private:
+
+    int64_t value = 0;
+
+};
+
+// Longest text any of the formatters below writes, sign and all
+export inline constexpr size_t kDurationTextMax = 32;
+
+// Writes 'v' with at least 'minDigits' digits at 'out', returns the end
+constexpr char* putDigits(char* out, uint64_t v, int minDigits) {
+
+    char digits[20] = {};
+    int n = 0;
+    do { digits[n++] = static_cast<char>('0' + v % 10); v /= 10; } while (v);
+    while (n < minDigits) digits[n++] = '0';
+    while (n) *out++ = digits[--n];
+    return out;
+
+}
+
+// 'precision' decimals of the sub-second part of 'ns' (a magnitude), with the dot, none for precision 0
+constexpr char* putFraction(char* out, uint64_t ns, int precision) {
+
+    if (precision <= 0) return out;
+    *out++ = '.';
+    return putDigits(out, (ns % Duration::kNsPerSecond) / static_cast<uint64_t>(Duration::unitOf(precision)), precision);
+
+}
+
+// "m:ss.f..." of a magnitude
+constexpr char* putClock(char* out, uint64_t ns, int precision) {
+
+    const uint64_t totalSeconds = ns / Duration::kNsPerSecond;
+    out = putDigits(out, totalSeconds / 60, 1);
+    *out++ = ':';
+    out = putDigits(out, totalSeconds % 60, 2);
+    return putFraction(out, ns, precision);
+
+}
+
+// |d| without overflowing on INT64_MIN
+constexpr uint64_t magnitudeOf(Duration d) {
+    return d.negative() ? static_cast<uint64_t>(-(d.ns() + 1)) + 1 : static_cast<uint64_t>(d.ns());
+}
+
+constexpr int clampPrecision(int precision) {
+    return precision < 0 ? 0 : precision > 9 ? 9 : precision;
+}
+
+// "m:ss.f..." with 'precision' decimals (0-9), truncated; '-' in front if negative. Returns the length.
+// No allocation, no floating point: callable every frame, and at compile time.
+export constexpr size_t formatDuration(Duration d, int precision, std::span<char, kDurationTextMax> out) {
+
+    precision = clampPrecision(precision);
+    const uint64_t ns = magnitudeOf(d);
+
+    char* p = out.data();
+    if (d.negative() && ns / static_cast<uint64_t>(Duration::unitOf(precision)) != 0) *p++ = '-';
+    p = putClock(p, ns, precision);
+    return static_cast<size_t>(p - out.data());
+
+}
+
+// What the timers and split rows show: "s.f..." below a minute, formatDuration() above. The sign is
+// dropped, the magnitude is shown.
+export constexpr size_t formatDurationCompact(Duration d, int precision, std::span<char, kDurationTextMax> out) {
+
+    precision = clampPrecision(precision);
+    const uint64_t ns = magnitudeOf(d);
+
+    char* p = out.data();
+    if (ns >= 60 * static_cast<uint64_t>(Duration::kNsPerSecond)) {
+        p = putClock(p, ns, precision);
+    } else {
+        p = putDigits(p, ns / Duration::kNsPerSecond, 1);
+        p = putFraction(p, ns, precision);
+    }
+    return static_cast<size_t>(p - out.data());
+
+}
+
+// A split's difference to its target: always signed, and below ten seconds as short as it goes
+// (+1.5, -.25, and a bare + when it cut to zero). Above a minute it is signed formatDuration().
+export constexpr size_t formatDelta(Duration d, int precision, std::span<char, kDurationTextMax> out) {
+
+    const uint64_t ns = magnitudeOf(d);
+    out[0] = d.negative() ? '-' : '+';
+
+    char core[kDurationTextMax] = {};
+    size_t n = formatDurationCompact(d, precision, core);
+
+    size_t begin = 0;
+    if (ns < 10 * static_cast<uint64_t>(Duration::kNsPerSecond)) {
+        if (core[0] == '0') begin = 1;                                      // leading zero before the dot
+        bool fraction = false;
+        for (size_t i = begin; i < n; ++i) fraction = fraction || core[i] == '.';
+        if (fraction) {
+            while (n > begin && core[n - 1] == '0') --n;                    // trailing zeros
+            if (n > begin && core[n - 1] == '.') --n;                       // dangling dot
+        }
+    }
+
+    for (size_t i = begin; i < n; ++i) out[1 + i - begin] = core[i];
+    return 1 + n - begin;
+
+}
+
+constexpr bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+// Reads "s", "s.f", "m:ss.f" or "h:mm:ss.f", with an optional sign and surrounding blanks. Every field
+// may have any number of digits, decimals beyond nanoseconds are cut. Fails on anything else, without
+// touching 'out' and without throwing.
+export constexpr bool parseDuration(std::string_view text, Duration& out) {
+
+    while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) text.remove_prefix(1);
+    while (!text.empty() && (text.back() == ' ' || text.back() == '\t')) text.remove_suffix(1);
+
+    bool negative = false;
+    if (!text.empty() && (text.front() == '+' || text.front() == '-')) {
+        negative = text.front() == '-';
+        text.remove_prefix(1);
+    }
+
+    int64_t seconds = 0;
+    int64_t field = 0;
+    int fieldDigits = 0;
+    int fields = 1;
+    size_t i = 0;
+
+    for (; i < text.size() && text[i] != '.'; ++i) {
+        if (text[i] == ':') {
+            if (!fieldDigits || fields == 3) return false;
+            seconds = (seconds + field) * 60;
+            field = 0;
+            fieldDigits = 0;
+            ++fields;
+        } else if (isDigit(text[i])) {
+            if (field > (INT64_MAX / Duration::kNsPerSecond) / 10) return false; // would overflow as ns
+            field = field * 10 + (text[i] - '0');
+            ++fieldDigits;
+        } else {
+            return false;
+        }
+    }
+    seconds += field;
+
+    int64_t fraction = 0;
+    int fractionDigits = 0;
+    if (i < text.size()) {
+        for (++i; i < text.size(); ++i) {
+            if (!isDigit(text[i])) return false;
+            if (fractionDigits < 9) fraction += (text[i] - '0') * Duration::unitOf(fractionDigits + 1);
+            ++fractionDigits;
+        }
+    }
+
+    // "5." and ".5" are fine, "." and "1:" aren't
+    if (!fieldDigits && (fields > 1 || !fractionDigits)) return false;
+    if (seconds > INT64_MAX / Duration::kNsPerSecond - 1) return false;
+
+    const int64_t ns = seconds * Duration::kNsPerSecond + fraction;
+    out = Duration::fromNs(negative ? -ns : ns);
+    return true;
+
+}
+
+// Round trips, checked at compile time: every value from 'begin' to 'end' in steps of 'stride' displayed
+// units (1: every text each format can produce in that range) parses back to itself, and a value between
+// two steps comes back cut to the step below.
+template <size_t (*Format)(Duration, int, std::span<char, kDurationTextMax>)>
+constexpr bool roundTrips(int precision, Duration begin, Duration end, int64_t stride = 1) {
+
+    const int64_t unit = Duration::unitOf(precision);
+    for (int64_t ns = begin.ns(); ns <= end.ns(); ns += unit * stride) {
+
+        for (const int64_t offset : { int64_t{0}, unit / 2, unit - 1 }) {
+
+            const Duration d = Duration::fromNs(ns + offset);
+            char text[kDurationTextMax] = {};
+            const size_t n = Format(d, precision, std::span<char, kDurationTextMax>(text));
+
+            Duration parsed;
+            const std::string_view written(text, n);
+            if (written == "+" || written == "-") parsed = Duration(); // formatDelta's zero
+            else if (!parseDuration(written, parsed)) return false;
+
+            Duration expected = d.truncated(precision);
+            if (Format == formatDurationCompact) expected = expected.abs();
+            if (parsed != expected) return false;
+
+        }
+
+    }
+    return true;
+
+}
+
+constexpr bool formatsAs(size_t (*format)(Duration, int, std::span<char, kDurationTextMax>), Duration d, int precision, std::string_view expected) {
+    char text[kDurationTextMax] = {};
+    return std::string_view(text, format(d, precision, std::span<char, kDurationTextMax>(text))) == expected;
+}
+
+constexpr bool parsesAs(std::string_view text, int64_t expectedNs) {
+    Duration d;
+    return parseDuration(text, d) && d.ns() == expectedNs;
+}
+
+constexpr bool rejects(std::string_view text) {
+    Duration d;
+    return !parseDuration(text, d);
+}
+
+// Every step across the places where the text changes shape: the minute, zero, ten seconds (deltas
+// lose their trimming), the hour and the last decimal.
+static_assert(roundTrips<formatDurationCompact>(3, Duration::fromMs(59900), Duration::fromMs(60100)));
+static_assert(roundTrips<formatDuration>(3, Duration::fromMs(-100), Duration::fromMs(100)));
+static_assert(roundTrips<formatDurationCompact>(2, Duration::fromMs(9500), Duration::fromMs(10500)));
+static_assert(roundTrips<formatDurationCompact>(1, Duration::fromSeconds(3590), Duration::fromSeconds(3610)));
+static_assert(roundTrips<formatDuration>(0, Duration::fromSeconds(3590), Duration::fromSeconds(3610)));
+static_assert(roundTrips<formatDelta>(3, Duration::fromMs(-100), Duration::fromMs(100)));
+static_assert(roundTrips<formatDelta>(3, Duration::fromMs(9900), Duration::fromMs(10100)));
+static_assert(roundTrips<formatDurationCompact>(9, Duration::fromNs(59'999'999'900), Duration::fromNs(60'000'000'100)));
+
+// Whole runs at every precision the timer shows, about 200 steps each. The strides are prime, so the steps
+// land on every digit of the fraction, the seconds and the minutes. Stepping through every value takes
+// more than a compiler will evaluate; nxTimerBenchTime does that.
+static_assert(roundTrips<formatDurationCompact>(3, Duration(), Duration::fromSeconds(2 * 3600), 36007));
+static_assert(roundTrips<formatDurationCompact>(2, Duration(), Duration::fromSeconds(24 * 3600), 43201));
+static_assert(roundTrips<formatDurationCompact>(1, Duration(), Duration::fromSeconds(24 * 3600), 4327));
+static_assert(roundTrips<formatDuration>(3, Duration::fromSeconds(-3600), Duration::fromSeconds(3600), 36007));
+static_assert(roundTrips<formatDuration>(0, Duration(), Duration::fromSeconds(100 * 3600), 1801));
+static_assert(roundTrips<formatDelta>(3, Duration::fromSeconds(-3600), Duration::fromSeconds(3600), 36007));
+
+// The texts the GUI showed before, exactly
+static_assert(formatsAs(formatDurationCompact, Duration(), 1, "0.0"));
+static_assert(formatsAs(formatDurationCompact, Duration::fromMs(5100), 1, "5.1"));
+static_assert(formatsAs(formatDurationCompact, Duration::fromMs(59999), 2, "59.99"));
+static_assert(formatsAs(formatDurationCompact, Duration::fromMs(60000), 2, "1:00.00"));
+static_assert(formatsAs(formatDurationCompact, Duration::fromMs(-1500), 3, "1.500"));
+static_assert(formatsAs(formatDuration, Duration::fromMs(3723400), 1, "62:03.4"));
+static_assert(formatsAs(formatDuration, Duration::fromMs(65000), 0, "1:05"));
+static_assert(formatsAs(formatDelta, Duration::fromMs(1500), 3, "+1.5"));
+static_assert(formatsAs(formatDelta, Duration::fromMs(-250), 3, "-.25"));
+static_assert(formatsAs(formatDelta, Duration(), 3, "+"));
+static_assert(formatsAs(formatDelta, Duration::fromMs(12300), 3, "+12.300"));
+static_assert(formatsAs(formatDelta, Duration::fromMs(-61000), 3, "-1:01.000"));
+static_assert(formatsAs(formatDuration, Duration::fromNs(INT64_MIN), 9, "-153722867:16.854775808"));
+
+static_assert(parsesAs("1:36.5", 96'500'000'000));
+static_assert(parsesAs(" 54.1\t", 54'100'000'000));
+static_assert(parsesAs("1:02:03", 3723'000'000'000));
+static_assert(parsesAs(".5", 500'000'000));
+static_assert(parsesAs("5.", 5'000'000'000));
+static_assert(parsesAs("-0.25", -250'000'000));
+static_assert(parsesAs("1.1234567899", 1'123'456'789));
+static_assert(rejects(""));
+static_assert(rejects("-"));
+static_assert(rejects("."));
+static_assert(rejects("1:"));
+static_assert(rejects(":5"));
+static_assert(rejects("1:2:3:4"));
+static_assert(rejects("1.5.2"));
+static_assert(rejects("12abc"));
+static_assert(rejects("99999999999999999999"));
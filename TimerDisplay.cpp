@@ -0,0 +1,274 @@
+module;
+
+#include <QWidget>
+#include <QPainter>
+#include <QPaintEvent>
+#include <QResizeEvent>
+#include <QPixmap>
+#include <QFont>
+#include <QFontMetrics>
+#include <QColor>
+#include <QString>
+#include <QRect>
+#include <QSize>
+#include <QSizePolicy>
+#include <initializer_list>
+#include <span>
+#include <string_view>
+#include <vector>
+#include <algorithm>
+
+export module TimerDisplay;
+
+// Digits and punctuation of one font, drawn once per colour into a strip and blitted from there.
+// Digits share the widest digit's advance (tabular figures), so a ticking timer never shifts its
+// other characters and only the cells that changed need repainting. Characters outside the strip
+// still work, they're drawn as text.
+export class GlyphAtlas {
+
+public:
+
+    static constexpr const char* kGlyphs = "0123456789:.+-() ";
+
+    explicit GlyphAtlas(const QFont& font) : font(font), metrics(font) {
+
+        for (char c = '0'; c <= '9'; ++c) digitAdvance = std::max(digitAdvance, metrics.horizontalAdvance(QChar(c)));
+
+        int x = 0;
+        for (const char* g = kGlyphs; *g; ++g) {
+            const int w = (*g >= '0' && *g <= '9') ? digitAdvance : metrics.horizontalAdvance(QChar(*g));
+            cells[static_cast<unsigned char>(*g)] = { x, w };
+            x += w + 1; // keep neighbours from bleeding into each other when scaled
+        }
+        stripWidth = x;
+
+    }
+
+    const QFont& glyphFont() const { return font; }
+    int height() const { return metrics.height(); }
+
+    int advance(QChar c) const {
+        const Cell_s* cell = cellOf(c);
+        return cell ? cell->width : metrics.horizontalAdvance(c);
+    }
+
+    int width(const QString& text) const {
+        int w = 0;
+        for (QChar c : text) w += advance(c);
+        return w;
+    }
+
+    // Draws 'c' with its top left corner at x/y
+    void draw(QPainter& painter, int x, int y, QChar c, QRgb color) {
+
+        if (const Cell_s* cell = cellOf(c)) {
+
+            const qreal dpr = painter.device()->devicePixelRatioF();
+            const QPixmap& strip = stripFor(color, dpr);
+            painter.drawPixmap(QRectF(x, y, cell->width, height()), strip,
+                               QRectF(cell->x * dpr, 0, cell->width * dpr, height() * dpr));
+
+        } else {
+
+            painter.setFont(font);
+            painter.setPen(QColor::fromRgba(color));
+            painter.drawText(QPointF(x, y + metrics.ascent()), QString(c));
+
+        }
+
+    }
+
+private:
+
+    struct Cell_s {
+
+        int x       = 0;
+        int width   = 0;
+
+    };
+
+    struct Strip_s {
+
+        QRgb    color   = 0;
+        qreal   dpr     = 1.0;
+        QPixmap pixmap;
+
+    };
+
+    const Cell_s* cellOf(QChar c) const {
+        return c.unicode() < 128 && cells[c.unicode()].width ? &cells[c.unicode()] : nullptr;
+    }
+
+    const QPixmap& stripFor(QRgb color, qreal dpr) {
+
+        for (const Strip_s& s : strips) {
+            if (s.color == color && s.dpr == dpr) return s.pixmap;
+        }
+
+        QPixmap pixmap(QSize(stripWidth, height()) * dpr);
+        pixmap.setDevicePixelRatio(dpr);
+        pixmap.fill(Qt::transparent);
+
+        QPainter p(&pixmap);
+        p.setRenderHint(QPainter::TextAntialiasing);
+        p.setFont(font);
+        p.setPen(QColor::fromRgba(color));
+        for (const char* g = kGlyphs; *g; ++g) {
+            const Cell_s& cell = cells[static_cast<unsigned char>(*g)];
+            const int ink = metrics.horizontalAdvance(QChar(*g));
+            p.drawText(QPointF(cell.x + (cell.width - ink) / 2.0, metrics.ascent()), QString(QChar(*g)));
+        }
+        p.end();
+
+        strips.push_back({ color, dpr, pixmap });
+        return strips.back().pixmap;
+
+    }
+
+    QFont                   font;
+    QFontMetrics            metrics;
+    int                     digitAdvance    = 0;
+    int                     stripWidth      = 0;
+    Cell_s                  cells[128]      = {};
+    std::vector<Strip_s>    strips;         // one per colour (and screen scale) in use, a handful at most
+
+};
+
+// Part of a GlyphLine: 'text' right-aligned in a column at least 'column' px wide
+export struct GlyphRun_s {
+
+    QString text;
+    QRgb    color   = 0;
+    int     column  = 0;
+
+};
+
+// One character placed by layoutGlyphRuns()
+export struct GlyphCell_s {
+
+    QChar   ch;
+    QRgb    color   = 0;
+    int     x       = 0;
+    int     width   = 0;
+
+    bool operator==(const GlyphCell_s&) const = default;
+
+};
+
+// Places 'runs' right to left, the last one ending at 'right', and appends their cells to 'out' right to left
+// (spaces take room but get no cell). Returns the left edge of the first run's column.
+export int layoutGlyphRuns(const GlyphAtlas& atlas, std::span<const GlyphRun_s> runs, int right, std::vector<GlyphCell_s>& out) {
+
+    for (auto run = runs.rbegin(); run != runs.rend(); ++run) {
+
+        int x = right;
+        for (qsizetype i = run->text.size(); i-- > 0; ) {
+            const QChar c = run->text[i];
+            const int w = atlas.advance(c);
+            x -= w;
+            if (c != QChar(' ')) out.push_back({ c, run->color, x, w });
+        }
+        right -= std::max(right - x, run->column);
+
+    }
+    return right;
+
+}
+
+// One line of right-aligned text painted from a GlyphAtlas. Setting new text compares it cell by cell
+// with what is on screen and repaints only the cells that changed, nothing is laid out or parsed again.
+export class GlyphLine : public QWidget {
+
+public:
+
+    explicit GlyphLine(GlyphAtlas& atlas, QWidget* parent = nullptr) : QWidget(parent), atlas(atlas) {
+        setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
+    }
+
+    QSize sizeHint() const override { return QSize(atlas.width(QStringLiteral("00:00.000")), atlas.height()); }
+    QSize minimumSizeHint() const override { return QSize(0, atlas.height()); }
+
+    void setText(const QString& text, QRgb color) {
+        setRuns({ { text, color, 0 } });
+    }
+
+    // Same for ASCII text formatted into a buffer (see TimeFormat). Text equal to the last call's is
+    // dropped before anything is converted, so redrawing a timer whose digits haven't moved costs a compare.
+    void setText(std::string_view text, QRgb color) {
+
+        if (lastAscii && color == lastAsciiColor && text == std::string_view(lastAsciiText, lastAsciiLength)) return;
+
+        setRuns({ { QString::fromLatin1(text.data(), static_cast<qsizetype>(text.size())), color, 0 } });
+
+        lastAscii = text.size() <= sizeof(lastAsciiText);
+        if (lastAscii) {
+            std::copy(text.begin(), text.end(), lastAsciiText);
+            lastAsciiLength = text.size();
+            lastAsciiColor = color;
+        }
+
+    }
+
+    // Runs are placed right to left, the last one ends at the right edge
+    void setRuns(std::initializer_list<GlyphRun_s> newRuns) {
+
+        lastAscii = false;
+        runs.assign(newRuns.begin(), newRuns.end());
+        relayout();
+
+    }
+
+protected:
+
+    void paintEvent(QPaintEvent* event) override {
+
+        QPainter painter(this);
+        const int top = (height() - atlas.height()) / 2;
+        const int left = event->rect().left();
+        const int right = event->rect().right();
+
+        for (const GlyphCell_s& c : cells) {
+            if (c.x + c.width > left && c.x <= right) atlas.draw(painter, c.x, top, c.ch, c.color);
+        }
+
+    }
+
+    void resizeEvent(QResizeEvent*) override {
+        relayout();
+    }
+
+private:
+
+    void relayout() {
+
+        next.clear();
+        layoutGlyphRuns(atlas, runs, width(), next);
+
+        // cells are compared from the right edge, where the text is anchored
+        QRect dirty;
+        for (size_t i = 0; i < std::max(cells.size(), next.size()); ++i) {
+
+            if (i < cells.size() && i < next.size() && cells[i] == next[i]) continue;
+
+            if (i < cells.size()) dirty |= QRect(cells[i].x, 0, cells[i].width, height());
+            if (i < next.size())  dirty |= QRect(next[i].x, 0, next[i].width, height());
+
+        }
+
+        cells.swap(next);
+        if (!dirty.isEmpty()) update(dirty);
+
+    }
+
+    GlyphAtlas&                 atlas;
+    std::vector<GlyphRun_s>     runs;
+    std::vector<GlyphCell_s>    cells;  // on screen, right to left
+    std::vector<GlyphCell_s>    next;   // scratch for relayout(), kept to reuse its storage
+
+    // what the last setText(std::string_view) showed, while nothing else was set since
+    bool                        lastAscii       = false;
+    char                        lastAsciiText[32];
+    size_t                      lastAsciiLength = 0;
+    QRgb                        lastAsciiColor  = 0;
+
+};
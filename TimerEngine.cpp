@@ -0,0 +1,398 @@
+module;
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
+#include <iterator>
+
+export module TimerEngine;
+
+export import GameSnapshot;
+
+// Start/split/pause/final-split logic as a pure function: no globals, no OS calls, no clock.
+// Everything a tick depends on is in the arguments and everything it changes is in the result,
+// so any number of engines can run side by side (worker, replay, fuzzers).
+
+// Hotkeys pressed since the previous step (timerStep) or in one timestamped press (timerInput).
+// TraceRecorder stores these bits as is, so recorded flags can be fed back in.
+export enum TimerInput : uint8_t {
+
+    INPUT_RESET         = 1 << 0,
+    INPUT_START_SPLIT   = 1 << 1,
+    INPUT_SKIP          = 1 << 2,
+    INPUT_UNDO          = 1 << 3,
+
+};
+
+export enum TimerEventKind : uint8_t {
+
+    EVENT_START,
+    EVENT_SPLIT,
+    EVENT_SKIP,
+    EVENT_UNDO,
+    EVENT_RESET,
+    EVENT_PAUSE,
+    EVENT_RESUME,
+    EVENT_FINAL,
+
+};
+
+// Lower case names for logs and overlays
+export const char* timerEventName(TimerEventKind kind) {
+
+    static constexpr const char* names[] = { "start", "split", "skip", "undo", "reset", "pause", "resume", "final" };
+    return kind < std::size(names) ? names[kind] : "unknown";
+
+}
+
+export struct TimerEvent_s {
+
+    TimerEventKind  kind        = EVENT_START;
+    size_t          splitIndex  = 0;    // index after the event
+    int64_t         timeNs      = 0;    // accumulated game time at the event
+    int64_t         timestampNs = 0;    // when it happened: the estimated transition instant for game events, the press for keys
+    int64_t         errorNs     = 0;    // the transition was at most this far from timestampNs
+
+};
+
+export struct TimerConfig_s {
+
+    float   syncLowerBound  = 0.0f;
+    float   syncUpperBound  = 0.0f;
+
+};
+
+export struct TimerEngineState_s {
+
+    // what the GUI shows
+    bool    timerRunning        = false;
+    bool    gameTimePaused      = true;
+    bool    displayTotal        = false;
+    size_t  currentSplitIndex   = 0;
+    int64_t accumulatedNs       = 0;     // game time, integer so long runs don't drift
+    int64_t errorBoundNs        = 0;     // sum of the error bounds of every load boundary in accumulatedNs
+
+    // what one step hands to the next
+    int64_t previousTimestampNs = 0;     // end of the previous read, time is accounted up to here
+    int64_t previousReadStartNs = 0;     // the previous read of the game's memory ran from here...
+    int64_t previousReadEndNs   = 0;     // ...to here
+    bool    wasRunningLastFrame = false;
+    bool    wasPausedLastFrame  = true;
+    bool    finalSplitTriggered = false; // Track if we've already done final split
+    GameMemorySnapshot_s previous;
+
+    // Set when the last evaluated step had nothing to react to and left every state unchanged.
+    // Until a watched byte changes or a key comes in, evaluating again would give the same result.
+    bool    settled             = false;
+
+};
+
+export struct TimerStep_s {
+
+    static constexpr size_t kMaxEvents = 8;
+
+    TimerEngineState_s  state;
+    uint16_t            changed     = 0;     // SnapshotField bits that differed from state.previous
+    bool                evaluated   = false; // false: short-circuited, only time was accumulated
+    int64_t             edgeNs      = 0;     // estimated instant of whatever changed since the previous read
+    int64_t             edgeErrorNs = 0;     // how far off edgeNs can be
+    size_t              eventCount  = 0;
+    TimerEvent_s        events[kMaxEvents];
+
+};
+
+// Call when the game was (re)attached: the time since the last step before the detach doesn't count
+// and the final split latch is released
+export constexpr TimerEngineState_s timerAttach(TimerEngineState_s s, int64_t timestampNs) {
+
+    s.previousTimestampNs = timestampNs;
+    s.previousReadStartNs = timestampNs;
+    s.previousReadEndNs   = timestampNs;
+    s.finalSplitTriggered = false;
+    s.settled             = false;
+    return s;
+
+}
+
+// Everything the decision logic can change, compared to detect a settled step
+struct DecisionState_s {
+
+    bool    timerRunning;
+    bool    gameTimePaused;
+    bool    displayTotal;
+    size_t  currentSplitIndex;
+    bool    wasRunningLastFrame;
+    bool    wasPausedLastFrame;
+    bool    finalSplitTriggered;
+
+    bool operator==(const DecisionState_s&) const = default;
+
+};
+
+static DecisionState_s captureDecisionState(const TimerEngineState_s& s) {
+
+    return { s.timerRunning, s.gameTimePaused, s.displayTotal, s.currentSplitIndex,
+             s.wasRunningLastFrame, s.wasPausedLastFrame, s.finalSplitTriggered };
+
+}
+
+static void emit(TimerStep_s& out, TimerEventKind kind, int64_t timestampNs) {
+
+    if (out.eventCount == TimerStep_s::kMaxEvents) return;
+    out.events[out.eventCount++] = { kind, out.state.currentSplitIndex, out.state.accumulatedNs, timestampNs, out.edgeErrorNs };
+
+}
+
+// Manual Key Handling, for keys sampled with a tick (timerStep) and for timestamped presses (timerInput)
+static void applyInputs(TimerStep_s& out, uint8_t inputs, int64_t timestampNs) {
+
+    TimerEngineState_s& s = out.state;
+
+    if (inputs & INPUT_RESET) {
+
+        s.timerRunning    = false;
+        s.accumulatedNs   = 0;
+        s.errorBoundNs    = 0;
+        s.currentSplitIndex = 0;
+        s.finalSplitTriggered = false;
+        emit(out, EVENT_RESET, timestampNs);
+
+    }
+
+    if (inputs & INPUT_START_SPLIT) {
+
+        if (!s.timerRunning) {
+
+            s.timerRunning = true;
+            s.accumulatedNs = 0;
+            s.errorBoundNs = 0;
+            s.currentSplitIndex = 0;
+            s.finalSplitTriggered = false;
+            emit(out, EVENT_START, timestampNs);
+
+        } else {
+
+            s.currentSplitIndex++;
+            emit(out, EVENT_SPLIT, timestampNs);
+
+        }
+
+    }
+
+    if (inputs & INPUT_SKIP) {
+        s.currentSplitIndex++;
+        emit(out, EVENT_SKIP, timestampNs);
+    }
+
+    if ((inputs & INPUT_UNDO) && (s.currentSplitIndex > 0)) {
+        s.currentSplitIndex--;
+        emit(out, EVENT_UNDO, timestampNs);
+    }
+
+}
+
+// Start/split/pause decisions for one step
+static void evaluate(TimerStep_s& out,
+                     const TimerConfig_s& config,
+                     const GameMemorySnapshot_s& current,
+                     uint8_t inputs,
+                     int64_t timestampNs) {
+
+    TimerEngineState_s& s = out.state;
+    const GameMemorySnapshot_s& previous = s.previous;
+
+    // Compute Changed states
+
+    bool loadingChanged = out.changed & FIELD_LOADING;
+
+    bool pausedChanged = out.changed & FIELD_IS_PAUSED;
+
+    bool globalTimerChanged = current.globalTimer != previous.globalTimer;
+
+    // FINAL SPLIT DETECTION (latch on the raw 5-bytes == "final")
+    const bool endIsFinalRaw = (std::memcmp(current.EndRaw, "final", 5) == 0);
+    if (endIsFinalRaw && !s.finalSplitTriggered) {
+
+        s.finalSplitTriggered = true;
+
+        if (s.timerRunning) {
+            s.currentSplitIndex++;
+        }
+        s.timerRunning = false;
+        s.displayTotal = true;
+        s.gameTimePaused = true;
+
+        emit(out, EVENT_FINAL, timestampNs);
+
+    }
+
+
+
+    // START LOGIC (block auto-start only if final split has latched)
+    if (!s.finalSplitTriggered && !s.timerRunning) {
+
+        s.displayTotal = false;
+
+        // Case 1
+        if (current.loading && loadingChanged) {
+
+            s.timerRunning    = true;
+            s.gameTimePaused  = true;
+            s.accumulatedNs   = 0;
+            s.errorBoundNs    = 0;
+            s.currentSplitIndex = 1; // index 0 is not assigned to any split, index 1 is the topest split
+            s.finalSplitTriggered = false;
+
+        }
+
+        // Case 2
+        if (!current.isPaused && pausedChanged && current.loading) {
+
+            s.timerRunning    = true;
+            s.gameTimePaused  = false;
+            s.accumulatedNs   = 0;
+            s.errorBoundNs    = 0;
+            s.currentSplitIndex = 1; // index 0 is not assigned to any split, index 1 is the topest split
+            s.finalSplitTriggered = false;
+
+        }
+
+        if (s.timerRunning) emit(out, EVENT_START, timestampNs);
+
+    }
+
+
+    // isLoading LOGIC (calculate before split logic)
+
+    bool isLoading =
+        !current.loading ||
+        (current.sync > config.syncLowerBound &&
+         current.sync < config.syncUpperBound) ||
+        current.prompt ||
+        (!current.isPaused &&
+         current.sync == 0 &&
+         !globalTimerChanged);
+
+
+    // AUTO-SPLIT LOGIC: Split when timer transitions from running to paused (loading starts)
+    // Only if timer is still running (not stopped by final split)
+
+    if (        s.timerRunning &&
+                s.wasRunningLastFrame &&
+                !s.wasPausedLastFrame &&
+                              isLoading &&
+           (previous.focusState == 1) &&
+           (current.focusState != 1)) {
+        s.currentSplitIndex++;
+        emit(out, EVENT_SPLIT, timestampNs);
+    }
+
+
+
+    // Update pause state (only if timer is still running)
+
+    if (s.timerRunning) {
+        if (s.gameTimePaused != isLoading) emit(out, isLoading ? EVENT_PAUSE : EVENT_RESUME, timestampNs);
+        s.gameTimePaused = isLoading;
+    }
+
+
+
+    applyInputs(out, inputs, timestampNs);
+
+    s.wasRunningLastFrame = s.timerRunning;
+    s.wasPausedLastFrame = s.gameTimePaused;
+
+}
+
+// Accurate Time Accumulation (delta-based)
+static void accumulate(TimerEngineState_s& s, int64_t timestampNs) {
+
+    const int64_t delta = timestampNs - s.previousTimestampNs;
+    s.previousTimestampNs = timestampNs;
+
+    if (s.timerRunning && !s.gameTimePaused) s.accumulatedNs += delta;
+
+}
+
+static bool isCounting(const TimerEngineState_s& s) {
+    return s.timerRunning && !s.gameTimePaused;
+}
+
+// One tick: the state after 'current' was read between 'readStartNs' and 'timestampNs' with 'inputs' pressed.
+// The decision stage only runs when a watched byte changed, a key fired or the last run hadn't settled;
+// otherwise a step is the diff plus the time accumulation.
+//
+// Whatever changed happened somewhere between the previous read and this one, so instead of giving the
+// whole delta to the new state it is split at edgeNs: the old state counts up to it, the new one after it.
+export TimerStep_s timerStep(const TimerEngineState_s& state,
+                             const TimerConfig_s& config,
+                             const GameMemorySnapshot_s& current,
+                             uint8_t inputs,
+                             int64_t readStartNs,
+                             int64_t timestampNs) {
+
+    TimerStep_s out;
+    out.state = state;
+    out.changed = diffSnapshots(current, state.previous);
+    inputs &= INPUT_RESET | INPUT_START_SPLIT | INPUT_SKIP | INPUT_UNDO;
+
+    if (!(out.changed == 0 && inputs == 0 && state.settled)) {
+
+        out.evaluated = true;
+
+        // halfway between the middles of both reads, the transition can be anywhere from the start
+        // of the previous read to the end of this one. Time that was already accounted stays accounted.
+        const int64_t previousMid = state.previousReadStartNs + (state.previousReadEndNs - state.previousReadStartNs) / 2;
+        const int64_t currentMid  = readStartNs + (timestampNs - readStartNs) / 2;
+        out.edgeNs      = std::min(std::max(previousMid + (currentMid - previousMid) / 2, state.previousTimestampNs), timestampNs);
+        out.edgeErrorNs = std::max(out.edgeNs - state.previousReadStartNs, timestampNs - out.edgeNs);
+
+        const bool wasCounting = isCounting(out.state);
+        accumulate(out.state, out.edgeNs);
+
+        const DecisionState_s before = captureDecisionState(out.state);
+        evaluate(out, config, current, inputs, out.edgeNs);
+        out.state.settled = out.changed == 0 && inputs == 0 && captureDecisionState(out.state) == before;
+
+        // a load boundary (or a start/stop) that moved counted time by up to edgeErrorNs
+        if (isCounting(out.state) != wasCounting && !(inputs & INPUT_RESET)) out.state.errorBoundNs += out.edgeErrorNs;
+
+    }
+
+    accumulate(out.state, timestampNs);
+
+    out.state.previousReadStartNs = readStartNs;
+    out.state.previousReadEndNs   = timestampNs;
+    out.state.previous = current;
+    return out;
+
+}
+
+// One key press between two ticks, at the time the OS saw it. Game time runs up to the press in the
+// pause state the last tick decided, then the key is handled; the game fields are left to the next timerStep.
+// A press older than the last step counts as happening at that step.
+export TimerStep_s timerInput(const TimerEngineState_s& state, uint8_t inputs, int64_t timestampNs) {
+
+    TimerStep_s out;
+    out.state = state;
+    inputs &= INPUT_RESET | INPUT_START_SPLIT | INPUT_SKIP | INPUT_UNDO;
+
+    timestampNs = std::max(timestampNs, state.previousTimestampNs);
+    accumulate(out.state, timestampNs);
+
+    if (inputs) {
+
+        out.evaluated = true;
+        applyInputs(out, inputs, timestampNs);
+
+        out.state.wasRunningLastFrame = out.state.timerRunning;
+        out.state.wasPausedLastFrame  = out.state.gameTimePaused;
+        out.state.settled = false;
+
+    }
+
+    return out;
+
+}
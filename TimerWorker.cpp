@@ -1,221 +1,667 @@
 module;
 
+#ifdef _WIN32
 #include <windows.h>
+#endif
 #include <chrono>
 #include <thread>
 #include <cstring>
 #include <atomic>
+#include <string>
+#include <vector>
+#include <ctime>
+#include <algorithm>
+#include <memory>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <span>
+
+#include "nxtimer_shm.h"
 
 export module TimerWorker;
 
 import GameMemory;
 import GameAddresses;
 import Settings;
+import TraceRecorder;
+export import TimerEngine;
+import SeqLock;
+import SpscQueue;
+import PollScheduler;
+import TickScheduler;
+import ProcessWatcher;
+import HotkeySource;
+import Instrumentation;
+import PerfTracer;
+import TimeFormat;
+import SharedState;
+
+// Everything the GUI shows, published by the worker as one unit so a reader never mixes two ticks
+export struct TimerSnapshot_s {
+
+    int64_t         accumulatedNs       = 0;
+    size_t          currentSplitIndex   = 0;
+    bool            timerRunning        = false;
+    bool            gameTimePaused      = true;
+    bool            displayTotal        = false;
+    TimerEventKind  lastEvent           = EVENT_RESET;
+    int64_t         lastEventNs         = 0;  // steady_clock time lastEvent happened at
+    int64_t         lastSplitNs         = 0;  // same for the last split, skip or final split
+    int64_t         errorBoundNs        = 0;  // accumulatedNs is exact to within this
+    int64_t         publishedNs         = 0;  // steady_clock timestamp of the tick this was taken at
+
+};
+
+SeqLock<TimerSnapshot_s> timerPublisher;
+TimerSnapshot_s published; // worker thread's copy, carries the last event fields between ticks
+
+// Every event the engine emitted, in order, for the GUI thread (the only consumer)
+SpscQueue<TimerEvent_s, 256> timerEvents;
+
+// The same events for the state server's thread, filled only once a server asked for them
+SpscQueue<TimerEvent_s, 256> serverEvents;
+std::atomic<bool> serverEventsWanted{false};
+
+// The same state and events for other processes, see nxtimer_shm.h. Only written once opened.
+SharedStateWriter sharedState;
+
+// Latest consistent timer state, callable from any thread. 'retries' counts the copies a concurrent publish spoiled.
+export TimerSnapshot_s readTimerSnapshot(uint64_t* retries = nullptr) {
+    return timerPublisher.read(retries);
+}
+
+// Next event from the worker, GUI thread only. Events carry the game time of the tick they happened
+// at, so a split is recorded with its exact time however late the GUI gets to it.
+export bool popTimerEvent(TimerEvent_s& out) {
+    return timerEvents.pop(out);
+}
+
+// Events the worker couldn't queue because the GUI was a full ring behind
+export uint64_t droppedTimerEvents() {
+    return timerEvents.droppedCount();
+}
+
+// From here on every event is queued for popServerEvent() too, call before the server's thread starts
+export void requestServerEvents() {
+    serverEventsWanted.store(true, std::memory_order_relaxed);
+}
+
+// Next event for the state server, its thread only
+export bool popServerEvent(TimerEvent_s& out) {
+    return serverEvents.pop(out);
+}
+
+export uint64_t droppedServerEvents() {
+    return serverEvents.droppedCount();
+}
+
+// Wakes the GUI when events are queued, so it needn't poll for them. Armed by the GUI before it drains
+// the queue and disarmed by the first batch after that: one call per batch however many pile up, and
+// none while the GUI hasn't caught up. Both sides exchange, so events queued before a disarm are
+// visible to the drain that follows the next arm.
+std::mutex notifierMutex;
+std::function<void()> eventNotifier;
+std::atomic<bool> notifierArmed{true};
+
+static void notifyTimerEvents() {
+
+    if (!notifierArmed.exchange(false)) return;
+
+    std::lock_guard lock(notifierMutex); // taken once per batch, a few times a minute
+    if (eventNotifier) eventNotifier();
+
+}
+
+// 'notify' runs on the worker thread and must only post to the GUI. Pass {} before the receiver goes away.
+export void setTimerEventNotifier(std::function<void()> notify) {
+    std::lock_guard lock(notifierMutex);
+    eventNotifier = std::move(notify);
+}
+
+// GUI thread, right before draining popTimerEvent()
+export void armTimerEventNotifier() {
+    notifierArmed.exchange(true);
+}
+
+// How many ticks ran the split/start/pause logic vs. were skipped because nothing changed
+export struct TickStats_s {
+
+    std::atomic<uint64_t> evaluated{0};
+    std::atomic<uint64_t> shortCircuited{0};
+
+    // ticks per poll tier, see PollScheduler
+    std::atomic<uint64_t> hotPolls{0};
+    std::atomic<uint64_t> steadyPolls{0};
+    std::atomic<uint64_t> idlePolls{0};
+
+} tickStats;
+
+// single writer (the worker), so a plain load/store is enough instead of a locked add
+static void bump(std::atomic<uint64_t>& counter) {
+    counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+TraceRecorder traceRecorder;
+std::atomic<bool> traceDumpRequested{false};
+
+PollScheduler pollScheduler;
+TickScheduler tickScheduler;
+ProcessWatcher processWatcher;
+std::unique_ptr<HotkeySource> hotkeys;
+
+// The worker's own thread, kept so exit can end it and wait: it writes through traceRecorder, the game's
+// memory source and the hotkey source, which are all gone once static destruction starts
+std::thread workerThread;
+std::atomic<bool> workerStopping{false};
+std::mutex workerWakeMutex;
+std::condition_variable workerWake;
+
+static bool workerStopRequested() {
+    return workerStopping.load(std::memory_order_relaxed);
+}
+
+// Sleeps while the game is away, cut short by stopTimerWorker()
+static void sleepUnlessStopped(std::chrono::milliseconds duration) {
+
+    std::unique_lock lock(workerWakeMutex);
+    workerWake.wait_for(lock, duration, [] { return workerStopRequested(); });
+
+}
+
+static int64_t toTraceTime(std::chrono::steady_clock::time_point t) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch()).count();
+}
+
+static std::string timestampedName(const char* prefix, const char* extension = ".nxtrace") {
+
+    char stamp[32] = {0};
+    const std::time_t t = std::time(nullptr);
+    std::strftime(stamp, sizeof(stamp), "%Y%m%d-%H%M%S", std::localtime(&t));
+    return std::string(prefix) + stamp + extension;
+
+}
+
+static nxtimer_state toSharedState(const TimerSnapshot_s& s) {
+
+    nxtimer_state out = {};
+    out.time_ns         = s.accumulatedNs;
+    out.error_ns        = s.errorBoundNs;
+    out.tick_ns         = s.publishedNs;
+    out.last_event_ns   = s.lastEventNs;
+    out.last_split_ns   = s.lastSplitNs;
+    out.split           = s.currentSplitIndex;
+    out.running         = s.timerRunning;
+    out.paused          = s.gameTimePaused;
+    out.finished        = s.displayTotal;
+    out.last_event      = s.lastEvent;
+    return out;
+
+}
+
+// Hands the engine state of one tick to the readers
+static void publish(const TimerEngineState_s& s, const TimerEvent_s* events, size_t eventCount) {
+
+    const bool toServer = serverEventsWanted.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < eventCount; ++i) {
+
+        timerEvents.push(events[i]);
+        if (toServer) serverEvents.push(events[i]);
+
+        published.lastEvent   = events[i].kind;
+        published.lastEventNs = events[i].timestampNs;
+        if (events[i].kind == EVENT_SPLIT || events[i].kind == EVENT_SKIP || events[i].kind == EVENT_FINAL) {
+            published.lastSplitNs = events[i].timestampNs;
+        }
+
+    }
+
+    published.accumulatedNs     = s.accumulatedNs;
+    published.errorBoundNs      = s.errorBoundNs;
+    published.currentSplitIndex = s.currentSplitIndex;
+    published.timerRunning      = s.timerRunning;
+    published.gameTimePaused    = s.gameTimePaused;
+    published.displayTotal      = s.displayTotal;
+    published.publishedNs       = s.previousTimestampNs;
+
+    timerPublisher.publish(published);
+    if (sharedState.isOpen()) sharedState.publish(toSharedState(published), events, eventCount);
+    if (eventCount) notifyTimerEvents();
+
+}
+
+// Publishes a state and its events the way a worker tick does, for driving the GUI without a game
+// (nxTimerBenchWindow). Not while TimerWorker() runs, the publication has one writer.
+export void publishTimerState(const TimerEngineState_s& s, std::span<const TimerEvent_s> events) {
+    publish(s, events.data(), events.size());
+}
+
+// Every publish from here on also goes to the shared-memory segment. TimerWorker() opens it when
+// settings.shared_memory is on; other publishers (nxTimerBenchShm) open it themselves.
+export bool openSharedState() {
+    return sharedState.isOpen() || sharedState.open();
+}
+
+// One live tick: step the engine, count it and publish the result. Returns the changed fields.
+static uint16_t processTick(TimerEngineState_s& engine,
+                            const TimerConfig_s& config,
+                            const GameMemorySnapshot_s& current,
+                            std::chrono::steady_clock::time_point readStart,
+                            std::chrono::steady_clock::time_point now) {
+
+    StageTimer decideTimer(STAGE_DECIDE);
+    const TimerStep_s step = timerStep(engine, config, current, 0, toTraceTime(readStart), toTraceTime(now));
+    decideTimer.stop();
+
+    bump(step.evaluated ? tickStats.evaluated : tickStats.shortCircuited);
+    engine = step.state;
+
+    StageTimer publishTimer(STAGE_PUBLISH);
+    publish(engine, step.events, step.eventCount);
+
+    return step.changed;
+
+}
+
+// Key presses that came in since the last tick, each applied at the time the OS saw it. Only the hotkey
+// ring is read here, so a tick without presses makes no input calls at all.
+static void processKeyEvents(TimerEngineState_s& engine, int64_t nowNs, uint8_t& traceFlags) {
 
-// Atomic here because the moment one thread writes those and another reads, has to be atomic to avoid UB
-export struct TimerState {
+    if (!hotkeys) return;
 
-    std::atomic<bool>   timerRunning{false};
-    std::atomic<bool>   gameTimePaused{true};
-    std::atomic<double> accumulatedTime{0.0};
-    std::atomic<bool>   displayTotal{false};
-    std::atomic<size_t> currentSplitIndex{0};
+    KeyEvent_s key;
+    while (hotkeys->poll(key)) {
 
-} timerState;
+        StageTimer timer(STAGE_KEYS);
+        const int64_t at = std::max(engine.previousTimestampNs, std::min(key.timestampNs, nowNs));
+        traceRecorder.record(at, key.input | TRACE_KEY_EVENT | traceFlags, engine.previous);
+        traceFlags = 0;
 
-// + or += aren't inherently atomic for doubles, making own atomic adder
-inline void atomicAdd(std::atomic<double>& a, double val) {
+        const TimerStep_s step = timerInput(engine, key.input, at);
+        engine = step.state;
+        publish(engine, step.events, step.eventCount);
 
-    double old = a.load(std::memory_order_relaxed);
-    double desired;
+    }
+
+}
+
+// Asks the worker to write its in-memory trace ring to trace_dump_<time>.nxtrace at the end of the next tick
+export void requestTraceDump() {
+    traceDumpRequested = true;
+}
+
+// Achieved tick rate, missed ticks and wake-up jitter of the worker so far, callable from any thread
+export TickSchedulerReport_s tickSchedulerReport() {
+    return tickScheduler.report();
+}
+
+// Writes tickSchedulerReport() to tick_report_<time>.txt, returns the file name or "" on failure
+export std::string saveTickReport() {
+
+    const std::string name = timestampedName("tick_report_", ".txt");
+    std::FILE* out = std::fopen(name.c_str(), "w");
+    if (!out) return "";
+
+    const std::string text = formatTickReport(tickScheduler.report());
+    std::fwrite(text.data(), 1, text.size(), out);
+    return std::fclose(out) == 0 ? name : "";
+
+}
+
+// Everything the worker measures about itself: stage latencies and counters (see Instrumentation), tick
+// rate and wake-up jitter, and how the ticks were spent. Callable from any thread.
+export std::string formatStats() {
+
+    std::string text = formatInstrumentation();
+    text += formatTickReport(tickScheduler.report());
+
+    text += "ticks evaluated: " + std::to_string(tickStats.evaluated.load(std::memory_order_relaxed))
+          + ", short-circuited: " + std::to_string(tickStats.shortCircuited.load(std::memory_order_relaxed)) + "\n";
+    text += "poll tiers hot/steady/idle: " + std::to_string(tickStats.hotPolls.load(std::memory_order_relaxed))
+          + " / " + std::to_string(tickStats.steadyPolls.load(std::memory_order_relaxed))
+          + " / " + std::to_string(tickStats.idlePolls.load(std::memory_order_relaxed)) + "\n";
+    text += "dropped timer events: " + std::to_string(timerEvents.droppedCount()) + "\n";
+    return text;
+
+}
+
+// Writes formatStats() and 'extra' (the GUI's own numbers) to stats_<time>.txt, returns the file name or "" on failure
+export std::string saveStats(const std::string& extra = {}) {
+
+    const std::string name = timestampedName("stats_", ".txt");
+    std::FILE* out = std::fopen(name.c_str(), "w");
+    if (!out) return "";
+
+    const std::string text = formatStats() + extra;
+    std::fwrite(text.data(), 1, text.size(), out);
+    return std::fclose(out) == 0 ? name : "";
+
+}
+
+// Ticks until the game exits, as often as pollScheduler asks for. ReadSnapshot is the read path for the attached build,
+// so the version is decided once per attach rather than on every tick.
+template <void (*ReadSnapshot)()>
+void tickWhileAttached(TimerEngineState_s& engine, const TimerConfig_s& config) {
+
+    tickScheduler.restart(std::chrono::steady_clock::time_point{std::chrono::nanoseconds(engine.previousTimestampNs)});
+    uint8_t traceFlags = TRACE_ATTACHED;
+
+    while (!processWatcher.exited() && !workerStopRequested()) {
+
+        StageTimer tickTimer(STAGE_TICK);
+
+        // bracket the read, the engine places transitions between the reads that saw them
+        const auto readStart = std::chrono::steady_clock::now();
+        ReadSnapshot();
+        const auto now = std::chrono::steady_clock::now();
+
+        const auto readNs = std::chrono::duration_cast<std::chrono::nanoseconds>(now - readStart).count();
+        recordStage(STAGE_READ, readStart, now);
+
+        processKeyEvents(engine, toTraceTime(now), traceFlags);
+
+        {
+            StageTimer traceTimer(STAGE_TRACE);
+            traceRecorder.record(toTraceTime(now), traceFlags, snapShotCurrent, static_cast<uint32_t>(std::min<int64_t>(readNs, UINT32_MAX)));
+            traceFlags = 0;
+        }
+
+        const uint16_t changed = processTick(engine, config, snapShotCurrent, readStart, now);
+
+        if (traceDumpRequested.exchange(false)) traceRecorder.dumpRing(timestampedName("trace_dump_"));
+
+        // Sleep until next cycle
 
-    do {
+        const auto interval = pollScheduler.next(snapShotCurrent, changed, engine.timerRunning, toTraceTime(now));
 
-        desired = old + val;
+        switch (pollScheduler.currentTier()) {
+            case POLL_HOT:      bump(tickStats.hotPolls);    break;
+            case POLL_STEADY:   bump(tickStats.steadyPolls); break;
+            case POLL_IDLE:     bump(tickStats.idlePolls);   break;
+        }
 
-    } while (!a.compare_exchange_weak(old, desired, std::memory_order_relaxed));
+        tickTimer.stop();
+        tickScheduler.waitNext(interval);
+        recordStage(STAGE_SLEEP_OVERSHOOT, tickScheduler.lastWakeup() - tickScheduler.lastLateness(), tickScheduler.lastWakeup());
+
+    }
 
 }
 
 export void TimerWorker() {
 
-    timerState.timerRunning      = false;
-    timerState.gameTimePaused    = true;
-    timerState.accumulatedTime   = 0.0;
-    timerState.currentSplitIndex = 0;
+    TimerEngineState_s engine;
+    TimerConfig_s config;
+    if (settings.shared_memory) openSharedState();
+    publish(engine, nullptr, 0);
 
-    auto previousTimePoint = std::chrono::steady_clock::now();
-    auto nextTick= previousTimePoint;
+    setPerfThreadName("worker");
+    if (settings.perf_trace) startPerfTrace(timestampedName("perf_trace_", ".json"));
 
-    bool gameWasNotReady        = false;
-    bool wasRunningLastFrame    = false;
-    bool wasPausedLastFrame     = true;
+    traceRecorder.configureRing(settings.trace_ring_seconds, settings.poll_rate_ceiling);
+    pollScheduler.configure(settings.poll_rate_ceiling, settings.poll_rate_floor);
+    tickScheduler.open({ static_cast<unsigned>(settings.tick_spin_us), settings.tick_cpu, settings.tick_high_priority });
 
-    std::atomic<bool> finalSplitTriggered{false}; // Track if we've already done final split (atomic to guarantee single increment)
+    hotkeys = makeHotkeySource();
+    if (!hotkeys->start({ settings.timer_reset, settings.timer_start_split, settings.timer_skip, settings.timer_undo })) {
+        hotkeys.reset();
+    }
 
+    // While detached only the process list is checked, and less often the longer the game stays away
+    DiscoveryBackoff backoff(std::chrono::milliseconds(50), std::chrono::milliseconds(1000));
 
-    while (true) {
 
-        nextTick += std::chrono::microseconds(500); // 0.5ms target 2000hz
+    while (!workerStopRequested()) {
 
         // Try to get addresses even if the games not running
         if (!isGameReady()) {
 
-            setupVersionOffsets();
-            gameWasNotReady = true;
-            finalSplitTriggered.store(false); // Reset on game disconnect
-            std::this_thread::sleep_for(std::chrono::microseconds(500));
+            if (findProcessId("XR_3DA.exe")) setupVersionOffsets();
+
+        }
+
+        if (!isGameReady() || !processWatcher.watch(gameAddresses.hProcess)) {
+
+            detachGame();
+
+            // there is no run to apply presses to while the game is away
+            KeyEvent_s stale;
+            while (hotkeys && hotkeys->poll(stale)) {}
+
+            sleepUnlessStopped(backoff.next());
             continue;
 
         }
 
-        if (gameWasNotReady) {
+        backoff.reset();
+        countEvent(COUNTER_ATTACHES);
 
-            previousTimePoint = std::chrono::steady_clock::now();
-            nextTick = previousTimePoint;
-            gameWasNotReady = false;
+        engine = timerAttach(engine, toTraceTime(std::chrono::steady_clock::now()));
 
+        config.syncLowerBound = versionOffsets.syncLowerBound;
+        config.syncUpperBound = versionOffsets.syncUpperBound;
+        traceRecorder.setSyncBounds(config.syncLowerBound, config.syncUpperBound);
+        pollScheduler.setSyncBounds(config.syncLowerBound, config.syncUpperBound);
+        pollScheduler.reset();
+        if (settings.record_trace && !traceRecorder.isFileOpen()) traceRecorder.openFile(timestampedName("trace_"));
+
+        switch (versionOffsets.version) {
+            case GAME_VERSION_1_0000:   tickWhileAttached<readGameMemorySnapshotFor<layout10000>>(engine, config); break;
+            case GAME_VERSION_1_0006:   tickWhileAttached<readGameMemorySnapshotFor<layout10006>>(engine, config); break;
+            default:                    tickWhileAttached<readGameMemorySnapshot>(engine, config);                 break;
         }
 
-        readGameMemorySnapshot();
+        // game exited (or the worker is stopping): release it and go back to looking for a new instance
+        processWatcher.stop();
+        detachGame();
+
+    }
 
-        // Compute Changed states
+    // stopTimerWorker(): the trace gets its last compacted record and is closed here, before the join
+    // returns, not by a static destructor while this thread may still be writing
+    traceRecorder.closeFile();
 
-        bool loadingChanged = snapShotCurrent.loading != snapShotPrevious.loading;
+    // Whatever path left the loop, the memory source goes with this thread too: readScatter() is only
+    // ever called from here, so after the join nothing can call into a source being destroyed
+    detachGame();
 
-        bool pausedChanged = snapShotCurrent.isPaused != snapShotPrevious.isPaused;
+    // The hotkey source's reader thread is stopped and joined here, after the last poll() and before
+    // the object is freed, rather than by the unique_ptr's static destructor
+    if (hotkeys) {
+        hotkeys->stop();
+        hotkeys.reset();
+    }
 
-        bool globalTimerChanged = snapShotCurrent.globalTimer != snapShotPrevious.globalTimer;
+}
 
-        // FINAL SPLIT DETECTION (latch on the raw 5-bytes == "final")
-        const bool endIsFinalRaw = (std::memcmp(snapShotCurrent.EndRaw, "final", 5) == 0);
-        if (endIsFinalRaw) {
-            // Only let one iteration perform the split/stop. compare_exchange guarantees only one will win.
-            bool expected = false;
-            if (finalSplitTriggered.compare_exchange_strong(expected, true)) {
+// Runs TimerWorker() on a thread of its own until stopTimerWorker()
+export void startTimerWorker() {
 
-                if (timerState.timerRunning.load()) {
-                    timerState.currentSplitIndex++;
-                }
-                timerState.timerRunning = false;
-                timerState.displayTotal = true;
-                timerState.gameTimePaused = true;
+    workerStopping.store(false, std::memory_order_relaxed);
+    workerThread = std::thread([] { TimerWorker(); });
 
-            }
-        }
+}
 
+// Ends the worker after its current tick and waits for it. Call before main returns, anything the worker
+// uses may be destroyed after that.
+export void stopTimerWorker() {
 
+    if (!workerThread.joinable()) return;
+    {
+        std::lock_guard lock(workerWakeMutex);
+        workerStopping.store(true, std::memory_order_relaxed);
+    }
+    workerWake.notify_all();
+    workerThread.join();
 
-        // START LOGIC (block auto-start only if final split has latched)
-        if (!finalSplitTriggered.load() && !timerState.timerRunning) {
+}
 
-            timerState.displayTotal = false;
+export struct ReplaySplit_s {
 
-            // Case 1
-            if (snapShotCurrent.loading && loadingChanged) {
+    size_t      splitIndex  = 0;
+    Duration    time;
 
-                timerState.timerRunning    = true;
-                timerState.gameTimePaused  = true;
-                timerState.accumulatedTime = 0.0;
-                timerState.currentSplitIndex = 1; // index 0 is not assigned to any split, index 1 is the topest split
-                finalSplitTriggered.store(false);
+};
 
-            }
+// What the adaptive poll rate would have cost over a trace, compared with polling at the ceiling.
+// Latencies are measured from the recorded tick that showed a transition to the first tick of the
+// simulated schedule at or after it, so the trace itself should be recorded with floor == ceiling.
+export struct PollReport_s {
 
-            // Case 2
-            if (!snapShotCurrent.isPaused && pausedChanged && snapShotCurrent.loading) {
+    uint64_t    fixedTicks              = 0;
+    uint64_t    adaptiveTicks           = 0;
+    double      fixedWorstSplitMs       = 0.0;
+    double      fixedWorstLoadMs        = 0.0;
+    double      adaptiveWorstSplitMs    = 0.0;
+    double      adaptiveWorstLoadMs     = 0.0;
 
-                timerState.timerRunning    = true;
-                timerState.gameTimePaused  = false;
-                timerState.accumulatedTime = 0.0;
-                timerState.currentSplitIndex = 1; // index 0 is not assigned to any split, index 1 is the topest split
-                finalSplitTriggered.store(false);
+};
 
-            }
+export struct ReplayResult_s {
 
-        }
+    bool    ok              = false;
+    size_t  records         = 0;
+    double  traceSeconds    = 0.0; // steady_clock span covered by the trace
+    double  wallSeconds     = 0.0; // how long the replay took
+    Duration finalTime;
+    double  finalErrorMs    = 0.0; // error bound of finalTime, from the load boundaries in it
+    double  worstBoundaryMs = 0.0; // largest error bound of a single load boundary
+    size_t  boundaries      = 0;
+    std::vector<ReplaySplit_s> splitChanges; // every change of currentSplitIndex, with the time it happened at
+    PollReport_s polling;
 
+};
 
-        // isLoading LOGIC (calculate before split logic)
+// Tick times a worker would have sampled at over the trace. With 'adaptive' unset it polls at a fixed
+// 'ceilingHz', otherwise pollScheduler decides, fed with the snapshot that was current at each tick.
+static std::vector<int64_t> simulateSchedule(const Trace_s& trace, const std::vector<bool>& runningAt, bool adaptive) {
 
-        bool isLoading =
-            !snapShotCurrent.loading ||
-            (snapShotCurrent.sync > versionOffsets.syncLowerBound &&
-             snapShotCurrent.sync < versionOffsets.syncUpperBound) ||
-            snapShotCurrent.prompt ||
-            (!snapShotCurrent.isPaused &&
-             snapShotCurrent.sync == 0 &&
-             !globalTimerChanged);
+    std::vector<int64_t> ticks;
+    if (trace.records.empty()) return ticks;
 
+    PollScheduler scheduler;
+    scheduler.configure(settings.poll_rate_ceiling, settings.poll_rate_floor);
+    scheduler.setSyncBounds(trace.header.syncLowerBound, trace.header.syncUpperBound);
+    scheduler.reset();
 
-        // AUTO-SPLIT LOGIC: Split when timer transitions from running to paused (loading starts)
-        // Only if timer is still running (not stopped by final split)
+    const int64_t fixedInterval = scheduler.interval(POLL_HOT).count();
+    const int64_t end = trace.records.back().timestampNs;
 
-        if (        timerState.timerRunning &&
-                        wasRunningLastFrame &&
-                        !wasPausedLastFrame &&
-                                  isLoading &&
-         (snapShotPrevious.focusState == 1) &&
-         (snapShotCurrent.focusState != 1)) {
-            timerState.currentSplitIndex++;
-        }
+    GameMemorySnapshot_s previous = trace.records.front().snapshot;
+    size_t i = 0;
 
+    for (int64_t t = trace.records.front().timestampNs; t <= end; ) {
 
+        while (i + 1 < trace.records.size() && trace.records[i + 1].timestampNs <= t) ++i;
+        ticks.push_back(t);
 
-        // Update pause state (only if timer is still running)
+        const GameMemorySnapshot_s& current = trace.records[i].snapshot;
+        t += adaptive ? scheduler.next(current, diffSnapshots(current, previous), runningAt[i], t).count()
+                      : fixedInterval;
+        previous = current;
 
-        if (timerState.timerRunning) {
-            timerState.gameTimePaused = isLoading;
-        }
+    }
 
+    return ticks;
 
+}
 
-        // Manual Key Handling
+// Worst distance from an event to the next tick of 'ticks', in ms
+static double worstLatencyMs(const std::vector<int64_t>& events, const std::vector<int64_t>& ticks) {
 
+    int64_t worst = 0;
+    for (int64_t e : events) {
+        const auto it = std::lower_bound(ticks.begin(), ticks.end(), e);
+        if (it != ticks.end()) worst = std::max(worst, *it - e);
+    }
+    return worst / 1e6;
 
-        if (GetAsyncKeyState(settings.timer_reset) & 1) {
+}
 
-            timerState.timerRunning    = false;
-            timerState.accumulatedTime = 0.0;
-            timerState.currentSplitIndex = 0;
-            finalSplitTriggered.store(false);
+// Sees every replayed record: its timestamp and the engine step it produced
+export using ReplayObserver = std::function<void(int64_t timestampNs, const TimerStep_s& step)>;
 
-        }
+// Feeds a recorded trace through the same timer engine as the live worker, as fast as possible.
+// Keeps its own engine state, so it can run next to TimerWorker() or other replays.
+export ReplayResult_s replayTrace(const std::string& path, const ReplayObserver& observer = {}) {
 
-        if (GetAsyncKeyState(settings.timer_start_split) & 1) {
+    ReplayResult_s result;
+    const auto wallStart = std::chrono::steady_clock::now();
 
-            if (!timerState.timerRunning) {
+    Trace_s trace;
+    if (!loadTrace(path, trace)) return result;
 
-                timerState.timerRunning = true;
-                timerState.accumulatedTime = 0.0;
-                timerState.currentSplitIndex = 0;
-                finalSplitTriggered.store(false);
+    TimerEngineState_s engine;
+    TimerConfig_s config;
+    config.syncLowerBound = trace.header.syncLowerBound;
+    config.syncUpperBound = trace.header.syncUpperBound;
 
-            } else timerState.currentSplitIndex++;
+    size_t lastSplitIndex = 0;
+    bool lastPaused = true;
+    bool first = true;
 
-        }
+    // inputs for the poll rate report
+    std::vector<bool> runningAt;
+    std::vector<int64_t> splitEvents;
+    std::vector<int64_t> loadEvents;
+    runningAt.reserve(trace.records.size());
 
-        if (GetAsyncKeyState(settings.timer_skip) & 1) timerState.currentSplitIndex++;
+    for (const TraceRecord_s& r : trace.records) {
 
-        if ((GetAsyncKeyState(settings.timer_undo) & 1) && (timerState.currentSplitIndex > 0)) timerState.currentSplitIndex--;
+        // a ring dump usually starts mid-run, treat its first record like an attach
+        if ((r.flags & TRACE_ATTACHED) || first) {
+            first = false;
+            engine = timerAttach(engine, r.timestampNs);
+        }
 
-        // Accurate Time Accumulation (delta-based)
+        const TimerStep_s step = (r.flags & TRACE_KEY_EVENT)
+                               ? timerInput(engine, r.flags, r.timestampNs)
+                               : timerStep(engine, config, r.snapshot, r.flags, r.timestampNs - r.readNs, r.timestampNs);
+        engine = step.state;
 
-        auto now = std::chrono::steady_clock::now();
-        std::chrono::duration<double> delta = now - previousTimePoint;
-        previousTimePoint = now;
+        for (size_t i = 0; i < step.eventCount; ++i) {
+            if (step.events[i].kind != EVENT_PAUSE && step.events[i].kind != EVENT_RESUME) continue;
+            ++result.boundaries;
+            result.worstBoundaryMs = std::max(result.worstBoundaryMs, step.events[i].errorNs / 1e6);
+        }
 
-        if (timerState.timerRunning && !timerState.gameTimePaused) atomicAdd(timerState.accumulatedTime, delta.count());
+        if (observer) observer(r.timestampNs, step);
 
-        // Copy snapshot for next iteration
+        const size_t splitIndex = engine.currentSplitIndex;
+        if (splitIndex != lastSplitIndex) {
+            result.splitChanges.push_back({ splitIndex, Duration::fromNs(engine.accumulatedNs) });
+            splitEvents.push_back(r.timestampNs);
+            lastSplitIndex = splitIndex;
+        }
 
-        snapShotPrevious = snapShotCurrent;
-        wasRunningLastFrame = timerState.timerRunning.load();
-        wasPausedLastFrame = timerState.gameTimePaused.load();
+        const bool running = engine.timerRunning;
+        const bool paused  = engine.gameTimePaused;
+        if (running && paused != lastPaused) loadEvents.push_back(r.timestampNs);
+        lastPaused = paused;
+        runningAt.push_back(running);
 
-        // Sleep until next cycle
+    }
 
-        std::this_thread::sleep_until(nextTick);
+    result.ok = true;
+    result.records = trace.records.size();
+    if (!trace.records.empty()) {
+        result.traceSeconds = (trace.records.back().timestampNs - trace.records.front().timestampNs) / 1e9;
     }
+    result.finalTime = Duration::fromNs(engine.accumulatedNs);
+    result.finalErrorMs = engine.errorBoundNs / 1e6;
+
+    const std::vector<int64_t> fixedTicks    = simulateSchedule(trace, runningAt, false);
+    const std::vector<int64_t> adaptiveTicks = simulateSchedule(trace, runningAt, true);
+
+    result.polling.fixedTicks           = fixedTicks.size();
+    result.polling.adaptiveTicks        = adaptiveTicks.size();
+    result.polling.fixedWorstSplitMs    = worstLatencyMs(splitEvents, fixedTicks);
+    result.polling.fixedWorstLoadMs     = worstLatencyMs(loadEvents, fixedTicks);
+    result.polling.adaptiveWorstSplitMs = worstLatencyMs(splitEvents, adaptiveTicks);
+    result.polling.adaptiveWorstLoadMs  = worstLatencyMs(loadEvents, adaptiveTicks);
+    result.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    return result;
 
 }
@@ -0,0 +1,250 @@
+module;
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+export module TraceRecorder;
+
+export import GameSnapshot;
+import TimerEngine;
+
+// Per-record flags: hotkeys sampled during the tick (the engine's TimerInput bits) plus worker events the replay has to mirror
+export enum TraceFlags : uint8_t {
+
+    TRACE_KEY_RESET         = INPUT_RESET,
+    TRACE_KEY_START_SPLIT   = INPUT_START_SPLIT,
+    TRACE_KEY_SKIP          = INPUT_SKIP,
+    TRACE_KEY_UNDO          = INPUT_UNDO,
+    TRACE_KEY_EVENT         = 1 << 6, // not a tick: one key press at its own timestamp, snapshot is the last tick's
+    TRACE_ATTACHED          = 1 << 7, // first tick after the game was (re)attached
+
+};
+
+// File layout: one 64 byte header followed by fixed-size, 8 byte aligned records, so a trace
+// can be mmap'ed and indexed directly. All fields are little endian.
+export struct TraceHeader_s {
+
+    char        magic[8]        = {'N', 'X', 'T', 'R', 'A', 'C', 'E', '1'};
+    uint32_t    version         = 1;
+    uint32_t    recordSize      = 0;
+    uint32_t    snapshotSize    = 0;
+    float       syncLowerBound  = 0.0f;
+    float       syncUpperBound  = 0.0f;
+    uint32_t    reserved[9]     = {};
+
+};
+
+export struct TraceRecord_s {
+
+    int64_t                 timestampNs = 0; // steady_clock::time_since_epoch()
+    uint8_t                 flags       = 0;
+    uint8_t                 reserved[3] = {};
+    uint32_t                readNs      = 0; // how long the memory read before timestampNs took, 0 in older traces
+    GameMemorySnapshot_s    snapshot;
+
+};
+
+static_assert(sizeof(TraceHeader_s) == 64);
+static_assert(sizeof(TraceRecord_s) % 8 == 0);
+
+export struct Trace_s {
+
+    TraceHeader_s               header;
+    std::vector<TraceRecord_s>  records;
+
+};
+
+// Records worker ticks, to a file and/or into an in-memory ring of the last few seconds.
+//
+// Ticks that repeat the previous snapshot without any hotkey are compacted: only the first and the
+// last tick of such a run are kept. Every tick in between would see the same state as the first
+// one, so replaying the two end points accounts exactly the same time.
+export class TraceRecorder {
+
+public:
+
+    ~TraceRecorder() { closeFile(); }
+
+    // Upper bound of the ring whatever trace_ring_seconds and the poll rate ask for, about 400k ticks
+    static constexpr size_t kMaxRingBytes = size_t{16} << 20;
+
+    void configureRing(double seconds, unsigned ticksPerSecond) {
+
+        ringSeconds = seconds;
+        ringLimit = static_cast<size_t>(std::min(seconds * ticksPerSecond + 1.0,
+                                                 static_cast<double>(kMaxRingBytes / sizeof(TraceRecord_s))));
+        ring.clear();
+        ring.shrink_to_fit();
+        ringHead = 0;
+        ringCount = 0;
+
+    }
+
+    void setSyncBounds(float lower, float upper) {
+
+        header.syncLowerBound = lower;
+        header.syncUpperBound = upper;
+
+    }
+
+    bool openFile(const std::string& path) {
+
+        closeFile();
+
+        file = std::fopen(path.c_str(), "wb");
+        if (!file) return false;
+
+        std::setvbuf(file, nullptr, _IOFBF, 1 << 20);
+        writeHeader(file);
+        return true;
+
+    }
+
+    void closeFile() {
+
+        if (!file) return;
+
+        if (hasPending) writeRecord(pending);
+        std::fclose(file);
+        file = nullptr;
+
+    }
+
+    bool isFileOpen() const { return file != nullptr; }
+
+    void record(int64_t timestampNs, uint8_t flags, const GameMemorySnapshot_s& snapshot, uint32_t readNs = 0) {
+
+        TraceRecord_s r;
+        r.timestampNs = timestampNs;
+        r.flags = flags;
+        r.readNs = readNs;
+        r.snapshot = snapshot;
+
+        const bool repeated = haveLast && flags == 0 &&
+                              std::memcmp(&snapshot, &last, sizeof(snapshot)) == 0;
+        last = snapshot;
+        haveLast = true;
+
+        if (repeated && ++stableTicks > 1) {
+
+            pending = r;
+            hasPending = true;
+            return;
+
+        }
+
+        if (!repeated) stableTicks = 0;
+
+        if (hasPending) {
+            emit(pending);
+            hasPending = false;
+        }
+        emit(r);
+
+    }
+
+    // Writes the ring (records newer than ringSeconds before the latest one) as a standalone trace
+    bool dumpRing(const std::string& path) const {
+
+        std::FILE* out = std::fopen(path.c_str(), "wb");
+        if (!out) return false;
+
+        writeHeader(out);
+
+        const int64_t newest = hasPending ? pending.timestampNs
+                             : ringCount ? ring[(ringHead + ring.size() - 1) % ring.size()].timestampNs : 0;
+        const int64_t oldest = newest - static_cast<int64_t>(ringSeconds * 1e9);
+
+        for (size_t i = 0; i < ringCount; ++i) {
+
+            const TraceRecord_s& r = ring[(ringHead + ring.size() - ringCount + i) % ring.size()];
+            if (r.timestampNs >= oldest) std::fwrite(&r, sizeof(r), 1, out);
+
+        }
+        if (hasPending) std::fwrite(&pending, sizeof(pending), 1, out);
+
+        return std::fclose(out) == 0;
+
+    }
+
+    uint64_t recordsEmitted() const { return emitted; }
+
+private:
+
+    void emit(const TraceRecord_s& r) {
+
+        ++emitted;
+        if (file) writeRecord(r);
+
+        if (ringLimit) {
+            // allocated with the first record, so a timer that never sees the game holds nothing
+            if (ring.empty()) ring.resize(ringLimit);
+            ring[ringHead] = r;
+            ringHead = (ringHead + 1) % ring.size();
+            if (ringCount < ring.size()) ++ringCount;
+        }
+
+    }
+
+    void writeHeader(std::FILE* out) const {
+
+        TraceHeader_s h = header;
+        h.recordSize   = sizeof(TraceRecord_s);
+        h.snapshotSize = sizeof(GameMemorySnapshot_s);
+        std::fwrite(&h, sizeof(h), 1, out);
+
+    }
+
+    void writeRecord(const TraceRecord_s& r) { std::fwrite(&r, sizeof(r), 1, file); }
+
+    TraceHeader_s               header;
+    std::FILE*                  file        = nullptr;
+
+    std::vector<TraceRecord_s>  ring;
+    size_t                      ringLimit   = 0;
+    size_t                      ringHead    = 0;
+    size_t                      ringCount   = 0;
+    double                      ringSeconds = 0.0;
+
+    GameMemorySnapshot_s        last;
+    bool                        haveLast    = false;
+    unsigned                    stableTicks = 0;
+    TraceRecord_s               pending;
+    bool                        hasPending  = false;
+
+    uint64_t                    emitted     = 0;
+
+};
+
+export bool loadTrace(const std::string& path, Trace_s& out) {
+
+    std::FILE* in = std::fopen(path.c_str(), "rb");
+    if (!in) return false;
+
+    bool ok = std::fread(&out.header, sizeof(out.header), 1, in) == 1 &&
+              std::memcmp(out.header.magic, "NXTRACE1", 8) == 0 &&
+              out.header.recordSize == sizeof(TraceRecord_s) &&
+              out.header.snapshotSize == sizeof(GameMemorySnapshot_s);
+
+    if (ok) {
+
+        std::fseek(in, 0, SEEK_END);
+        const long end = std::ftell(in);
+        std::fseek(in, sizeof(TraceHeader_s), SEEK_SET);
+
+        const size_t count = end > static_cast<long>(sizeof(TraceHeader_s))
+                           ? (static_cast<size_t>(end) - sizeof(TraceHeader_s)) / sizeof(TraceRecord_s) : 0;
+        out.records.resize(count);
+        ok = std::fread(out.records.data(), sizeof(TraceRecord_s), count, in) == count;
+
+    }
+
+    std::fclose(in);
+    return ok;
+
+}
@@ -0,0 +1,163 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+import TimerEngine;
+import TraceRecorder;
+
+// nxTimerBenchEngine: how many ticks per second the timer's decision logic (timerStep/timerInput)
+// gets through on its own, with no memory reads, scheduling or bookkeeping around it. The ticks are
+// those of a recorded trace, or every tick of a scripted 1.0006 run at 2000 Hz: [levels] levels of
+// 30 s of play at about 144 fps, a skip and an undo in each, then a 5 s load with its split, and the
+// final split at the end. Every pass replays all ticks from the same state.
+//
+// usage: nxTimerBenchEngine [passes] [levels | trace.nxtrace]
+
+static constexpr int64_t kTickNs        = 500'000;          // 2000 Hz
+static constexpr int     kTicksPerFrame = 14;               // about 144 fps
+static constexpr int64_t kLevelNs       = 30'000'000'000;
+static constexpr int64_t kLoadNs        = 5'000'000'000;
+
+static volatile int64_t keep; // results go here, so the timed loop can't be optimized away
+
+static Trace_s scriptedRun(int levels) {
+
+    Trace_s trace;
+    trace.header.syncLowerBound = 0.09f;
+    trace.header.syncUpperBound = 0.11f;
+    trace.records.reserve(static_cast<size_t>(levels) * ((kLevelNs + kLoadNs) / kTickNs + 2) + 400);
+
+    GameMemorySnapshot_s s;
+    s.focusState = 2;
+    s.sync = 0.016f;
+
+    int64_t t = 1'000'000'000;
+    auto tick = [&](uint8_t flags) {
+        TraceRecord_s r;
+        r.timestampNs = t;
+        r.flags = flags;
+        r.readNs = 20'000;
+        r.snapshot = s;
+        trace.records.push_back(r);
+        if (!(flags & TRACE_KEY_EVENT)) t += kTickNs;
+    };
+
+    // main menu; the first level coming in starts the timer
+    for (int i = 0; i < 200; ++i) tick(i == 0 ? TRACE_ATTACHED : 0);
+
+    for (int level = 0; level < levels; ++level) {
+
+        s.loading = true;
+        s.focusState = 1;
+        std::snprintf(s.End, sizeof(s.End), "l%02d", level % 100);
+        std::memcpy(s.EndRaw, s.End, sizeof(s.End));
+
+        for (int64_t played = 0, frame = 0; played < kLevelNs; played += kTickNs, ++frame) {
+            if (frame % kTicksPerFrame == 0) s.globalTimer += kTicksPerFrame * static_cast<float>(kTickNs) / 1e9f;
+            tick(0);
+            if (played == kLevelNs / 3) tick(TRACE_KEY_SKIP | TRACE_KEY_EVENT);
+            if (played == kLevelNs / 2) tick(TRACE_KEY_UNDO | TRACE_KEY_EVENT);
+        }
+
+        // level change: focus goes on the read the load starts on, which is the split
+        s.loading = false;
+        s.focusState = 2;
+        for (int64_t loaded = 0; loaded < kLoadNs; loaded += kTickNs) tick(0);
+
+    }
+
+    s.loading = true;
+    std::memcpy(s.EndRaw, "final", 5);
+    std::memcpy(s.End, "final", 5);
+    for (int i = 0; i < 200; ++i) tick(0);
+
+    return trace;
+
+}
+
+struct PassResult_s {
+
+    TimerEngineState_s  state;
+    uint64_t            evaluated   = 0;
+    uint64_t            events      = 0;
+
+};
+
+// The same calls replayTrace() makes per record, nothing else
+static PassResult_s replayPass(const Trace_s& trace) {
+
+    PassResult_s result;
+    TimerEngineState_s engine;
+    TimerConfig_s config;
+    config.syncLowerBound = trace.header.syncLowerBound;
+    config.syncUpperBound = trace.header.syncUpperBound;
+
+    bool first = true;
+    for (const TraceRecord_s& r : trace.records) {
+
+        if ((r.flags & TRACE_ATTACHED) || first) {
+            first = false;
+            engine = timerAttach(engine, r.timestampNs);
+        }
+
+        const TimerStep_s step = (r.flags & TRACE_KEY_EVENT)
+                               ? timerInput(engine, r.flags, r.timestampNs)
+                               : timerStep(engine, config, r.snapshot, r.flags, r.timestampNs - r.readNs, r.timestampNs);
+        engine = step.state;
+        result.evaluated += step.evaluated;
+        result.events += step.eventCount;
+
+    }
+
+    result.state = engine;
+    return result;
+
+}
+
+int main(int argc, char** argv) {
+
+    const int passes = argc > 1 ? std::atoi(argv[1]) : 5;
+    const std::string source = argc > 2 ? argv[2] : "10";
+    const bool scripted = source.find_first_not_of("0123456789") == std::string::npos;
+    const int levels = scripted ? std::atoi(source.c_str()) : 0;
+    if (passes <= 0 || (scripted && (levels <= 0 || levels > 1000))) {
+        std::fprintf(stderr, "usage: %s [passes] [levels | trace.nxtrace]\n", argv[0]);
+        return 2;
+    }
+
+    Trace_s trace;
+    if (scripted) trace = scriptedRun(levels);
+    else if (!loadTrace(source, trace)) {
+        std::printf("can't read %s\n", source.c_str());
+        return 1;
+    }
+
+    double best = 1e300;
+    PassResult_s result;
+    for (int pass = 0; pass < passes; ++pass) {
+        const auto start = std::chrono::steady_clock::now();
+        result = replayPass(trace);
+        best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+        keep = result.state.accumulatedNs;
+    }
+
+    const double ticks = static_cast<double>(trace.records.size());
+    std::printf("%s: %zu ticks, %.1f%% evaluated, %llu events, final split %zu at %.3f s\n",
+                scripted ? "scripted run" : source.c_str(), trace.records.size(), 100.0 * result.evaluated / ticks,
+                static_cast<unsigned long long>(result.events), result.state.currentSplitIndex, result.state.accumulatedNs / 1e9);
+    std::printf("best of %d passes: %.2f ms, %.1f ns/tick, %.1f M ticks/s\n", passes, best * 1e3, best * 1e9 / ticks, ticks / best / 1e6);
+
+    // the start puts the run on split 1, every load one further and the final split one more; skips
+    // and undos cancel out, and only the levels themselves are game time
+    if (scripted && (result.state.currentSplitIndex != static_cast<size_t>(levels) + 2 || !result.state.displayTotal ||
+                     result.state.accumulatedNs != levels * kLevelNs)) {
+        std::printf("the scripted run should end on split %d after %d s of game time, with the total shown\n",
+                    levels + 2, static_cast<int>(levels * kLevelNs / 1'000'000'000));
+        return 1;
+    }
+    return 0;
+
+}
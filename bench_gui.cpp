@@ -0,0 +1,403 @@
+#include <QApplication>
+#include <QWidget>
+#include <QLabel>
+#include <QGridLayout>
+#include <QFont>
+#include <QFontMetrics>
+#include <QColor>
+#include <QString>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <vector>
+#include <functional>
+
+import TimerDisplay;
+import SplitTable;
+
+// nxTimerBenchGui: per-frame cost of the timer window's refresh, the old QLabel path (setText plus
+// setStyleSheet on every refresh, split rows as rich text tables) against GlyphLine. Then the split
+// table over a long route: 1000 splits, undos back through half of them, the splits again and a reset,
+// with the old fixed label rows rebuilt on every scroll against SplitTableView. Runs on Qt's offscreen
+// platform, so it needs no display and measures layout and painting into the backing store.
+//
+// usage: nxTimerBenchGui [frames] [splits]
+
+static constexpr int kSplitRows = 11;
+static constexpr int kSplitEvery = 20; // a split every second at the 20 Hz refresh
+static constexpr size_t kTableRows = kSplitRows;
+
+static QString formatSeconds(double seconds, int precision) {
+    const int minutes = static_cast<int>(seconds) / 60;
+    const double rest = seconds - minutes * 60;
+    return minutes ? QString("%1:%2").arg(minutes).arg(rest, precision + 3, 'f', precision, QChar('0'))
+                   : QString::number(rest, 'f', precision);
+}
+
+// What GUIFrame built for every split row before GlyphLine
+static QString splitTimeHtml(const QFont& font, const QString& timeText, const QString& deltaText, const QString& color) {
+    const QFontMetrics fm(font);
+    const int timeWidth = fm.horizontalAdvance("0:00.000");
+    const int gapWidth = fm.horizontalAdvance("  ");
+    const int deltaWidth = fm.horizontalAdvance("(-0:00.000)");
+    const QString deltaCell = deltaText.isEmpty() ? QString("&nbsp;") : QString("<span style=\"color:%1;\">%2</span>").arg(color, deltaText);
+    return QString(
+        "<div align=\"right\">"
+        "<table cellpadding=\"0\" cellspacing=\"0\"><tr>"
+        "<td width=\"%1\" align=\"right\">%2</td>"
+        "<td width=\"%3\"></td>"
+        "<td width=\"%4\" align=\"right\">%5</td>"
+        "</tr></table>"
+        "</div>"
+    ).arg(deltaWidth).arg(deltaCell).arg(gapWidth).arg(timeWidth).arg(timeText);
+}
+
+struct Fonts_s {
+
+    QFont timer     = QFont("Segoe UI", 28, QFont::Bold);
+    QFont splits    = QFont("Segoe UI", 12, QFont::Bold);
+
+};
+
+// One window in the layout of GridWidget: two big timers, the split rows and the total
+class LabelWindow : public QWidget {
+
+public:
+
+    explicit LabelWindow(const Fonts_s& fonts) {
+
+        auto* grid = new QGridLayout(this);
+        total = addTimer(grid, fonts.timer, 0);
+        segment = addTimer(grid, fonts.timer, 1);
+
+        for (int i = 0; i < kSplitRows; ++i) {
+            auto* name = new QLabel(QString("Split %1").arg(i + 1), this);
+            name->setFont(fonts.splits);
+            grid->addWidget(name, 2 + i, 0);
+
+            auto* time = new QLabel(this);
+            time->setFont(fonts.splits);
+            time->setAlignment(Qt::AlignRight);
+            time->setTextFormat(Qt::RichText);
+            time->setText(splitTimeHtml(fonts.splits, "0.000", QString(), QString()));
+            grid->addWidget(time, 2 + i, 1);
+            splits.push_back(time);
+        }
+        setFixedSize(400, 500);
+
+    }
+
+    void frame(int n, double seconds, bool split) {
+
+        total->setText(formatSeconds(seconds, 2));
+        total->setStyleSheet(QString("QLabel { color: %1; }").arg("#39FF14"));
+        segment->setText(formatSeconds(seconds - lastSplit, 2));
+        segment->setStyleSheet(QString("QLabel { color: %1; }").arg("#00BFFF"));
+
+        if (split) {
+            QLabel* row = splits[(n / kSplitEvery) % kSplitRows];
+            row->setText(splitTimeHtml(row->font(), formatSeconds(seconds - lastSplit, 3), "(+0.123)", "#FF0000"));
+            lastSplit = seconds;
+        }
+
+    }
+
+private:
+
+    QLabel* addTimer(QGridLayout* grid, const QFont& font, int row) {
+        auto* label = new QLabel(this);
+        label->setFont(font);
+        label->setAlignment(Qt::AlignRight | Qt::AlignVCenter);
+        grid->addWidget(label, row, 0, 1, 2);
+        return label;
+    }
+
+    QLabel* total;
+    QLabel* segment;
+    std::vector<QLabel*> splits;
+    double lastSplit = 0.0;
+
+};
+
+class GlyphWindow : public QWidget {
+
+public:
+
+    explicit GlyphWindow(const Fonts_s& fonts) : timerGlyphs(fonts.timer), splitGlyphs(fonts.splits) {
+
+        auto* grid = new QGridLayout(this);
+        total = new GlyphLine(timerGlyphs, this);
+        grid->addWidget(total, 0, 0, 1, 2);
+        segment = new GlyphLine(timerGlyphs, this);
+        grid->addWidget(segment, 1, 0, 1, 2);
+
+        deltaColumn = splitGlyphs.width("(-0:00.000)");
+        gapColumn = splitGlyphs.width("  ");
+        timeColumn = splitGlyphs.width("0:00.000");
+
+        for (int i = 0; i < kSplitRows; ++i) {
+            auto* name = new QLabel(QString("Split %1").arg(i + 1), this);
+            name->setFont(fonts.splits);
+            grid->addWidget(name, 2 + i, 0);
+
+            auto* time = new GlyphLine(splitGlyphs, this);
+            time->setRuns({ { QString(), 0, deltaColumn }, { QString(), 0, gapColumn }, { "0.000", qRgb(255, 255, 255), timeColumn } });
+            grid->addWidget(time, 2 + i, 1);
+            splits.push_back(time);
+        }
+        setFixedSize(400, 500);
+
+    }
+
+    void frame(int n, double seconds, bool split) {
+
+        total->setText(formatSeconds(seconds, 2), qRgb(0x39, 0xFF, 0x14));
+        segment->setText(formatSeconds(seconds - lastSplit, 2), qRgb(0x00, 0xBF, 0xFF));
+
+        if (split) {
+            splits[(n / kSplitEvery) % kSplitRows]->setRuns({
+                { "(+0.123)", qRgb(255, 0, 0), deltaColumn },
+                { QString(), 0, gapColumn },
+                { formatSeconds(seconds - lastSplit, 3), qRgb(255, 255, 255), timeColumn },
+            });
+            lastSplit = seconds;
+        }
+
+    }
+
+private:
+
+    GlyphAtlas timerGlyphs;
+    GlyphAtlas splitGlyphs;
+    GlyphLine* total;
+    GlyphLine* segment;
+    std::vector<GlyphLine*> splits;
+    int deltaColumn = 0;
+    int gapColumn = 0;
+    int timeColumn = 0;
+    double lastSplit = 0.0;
+
+};
+
+// The split table before SplitTableView: a fixed set of label rows, every one rebuilt whenever the window scrolls
+class LabelSplitTable : public QWidget {
+
+public:
+
+    LabelSplitTable(const Fonts_s& fonts, size_t splits) : font(fonts.splits), count(splits) {
+
+        auto* grid = new QGridLayout(this);
+        for (size_t i = 0; i < kTableRows; ++i) {
+            auto* name = new QLabel(this);
+            name->setFont(fonts.splits);
+            grid->addWidget(name, static_cast<int>(i), 0);
+            names.push_back(name);
+
+            auto* time = new QLabel(this);
+            time->setFont(fonts.splits);
+            time->setAlignment(Qt::AlignRight);
+            time->setTextFormat(Qt::RichText);
+            grid->addWidget(time, static_cast<int>(i), 1);
+            times.push_back(time);
+        }
+        setFixedSize(400, 500);
+        rebuild();
+
+    }
+
+    void split(double t) {
+
+        completed.push_back(t);
+        const size_t i = completed.size() - 1;
+        if (i >= top && i - top < times.size()) times[i - top]->setText(splitTimeHtml(font, formatSeconds(t, 3), "(+0.123)", "#FF0000"));
+        if (completed.size() >= top + kTableRows && top + kTableRows < count) { ++top; rebuild(); }
+
+    }
+
+    void undo() {
+
+        completed.pop_back();
+        const size_t desired = completed.size() >= kTableRows ? completed.size() - kTableRows + 1 : 0;
+        if (desired < top) top = desired;
+        rebuild();
+
+    }
+
+    void reset() {
+
+        completed.clear();
+        top = 0;
+        rebuild();
+
+    }
+
+private:
+
+    void rebuild() {
+
+        for (size_t i = 0; i < names.size(); ++i) {
+            const size_t row = top + i;
+            names[i]->setText(QString("Split %1").arg(row + 1));
+            times[i]->setText(row < completed.size() ? splitTimeHtml(font, formatSeconds(completed[row], 3), "(+0.123)", "#FF0000")
+                                                     : splitTimeHtml(font, "0.000", QString(), QString()));
+        }
+
+    }
+
+    QFont                   font;
+    std::vector<QLabel*>    names;
+    std::vector<QLabel*>    times;
+    std::vector<double>     completed;
+    size_t                  count;
+    size_t                  top = 0;
+
+};
+
+class ViewSplitTable : public QWidget {
+
+public:
+
+    ViewSplitTable(const Fonts_s& fonts, size_t splits) : glyphs(fonts.splits) {
+
+        std::vector<SplitRow_s> rows;
+        for (size_t i = 0; i < splits; ++i) rows.push_back(pendingRow(i));
+        model.assign(std::move(rows));
+
+        auto* grid = new QGridLayout(this);
+        view = new SplitTableView(model, glyphs, fonts.splits, qRgb(255, 255, 255), qRgb(255, 255, 255), kTableRows, 3, this);
+        grid->addWidget(view, 0, 0);
+        setFixedSize(400, 500);
+
+    }
+
+    void split(double t) {
+
+        const size_t i = completed.size();
+        completed.push_back(t);
+        model.setRow(i, { QString("Split %1").arg(i + 1), formatSeconds(t, 3), "(+0.123)", qRgb(255, 0, 0) });
+        if (completed.size() >= view->top() + kTableRows) view->setTop(view->top() + 1);
+
+    }
+
+    void undo() {
+
+        completed.pop_back();
+        model.setRow(completed.size(), pendingRow(completed.size()));
+        const size_t desired = completed.size() >= kTableRows ? completed.size() - kTableRows + 1 : 0;
+        if (desired < view->top()) view->setTop(desired);
+
+    }
+
+    void reset() {
+
+        for (size_t i = 0; i < completed.size(); ++i) model.setRow(i, pendingRow(i));
+        completed.clear();
+        view->setTop(0);
+
+    }
+
+private:
+
+    static SplitRow_s pendingRow(size_t i) {
+        return { QString("Split %1").arg(i + 1), "0.000", QString(), 0 };
+    }
+
+    GlyphAtlas              glyphs;
+    SplitTableModel         model;
+    SplitTableView*         view;
+    std::vector<double>     completed;
+
+};
+
+struct Result_s {
+
+    double wallUs   = 0.0;
+    double cpuUs    = 0.0;
+
+};
+
+// Runs 'frames' refreshes, each followed by the event processing that lays out and paints it
+static Result_s run(int frames, const std::function<void(int, double, bool)>& frame) {
+
+    for (int n = 0; n < 50; ++n) { frame(n, n * 0.05, false); QApplication::processEvents(); } // warm up caches and glyph strips
+
+    const auto wallStart = std::chrono::steady_clock::now();
+    const std::clock_t cpuStart = std::clock();
+
+    for (int n = 0; n < frames; ++n) {
+        frame(n, 60.0 + n * 0.05, n % kSplitEvery == 0);
+        QApplication::processEvents();
+    }
+
+    Result_s r;
+    r.cpuUs = (std::clock() - cpuStart) * 1e6 / CLOCKS_PER_SEC / frames;
+    r.wallUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - wallStart).count() / frames;
+    return r;
+
+}
+
+// 'splits' splits, undo back through half of them, split to the end again, reset: one operation per event,
+// each followed by the event processing that paints it. Returns the cost per operation.
+template <class Table>
+static Result_s runSplitTable(Table& table, size_t splits) {
+
+    size_t ops = 0;
+    const auto process = [&ops] { QApplication::processEvents(); ++ops; };
+
+    const auto wallStart = std::chrono::steady_clock::now();
+    const std::clock_t cpuStart = std::clock();
+
+    for (size_t i = 0; i < splits; ++i) { table.split(60.0 * (i + 1)); process(); }
+    for (size_t i = 0; i < splits / 2; ++i) { table.undo(); process(); }
+    for (size_t i = splits / 2; i < splits; ++i) { table.split(60.0 * (i + 1)); process(); }
+    table.reset();
+    process();
+
+    Result_s r;
+    r.cpuUs = (std::clock() - cpuStart) * 1e6 / CLOCKS_PER_SEC / ops;
+    r.wallUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - wallStart).count() / ops;
+    return r;
+
+}
+
+int main(int argc, char** argv) {
+
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) qputenv("QT_QPA_PLATFORM", "offscreen");
+    QApplication app(argc, argv);
+
+    const int frames = argc > 1 ? std::atoi(argv[1]) : 2000;
+    const size_t splits = argc > 2 ? static_cast<size_t>(std::atoi(argv[2])) : 1000;
+    const Fonts_s fonts;
+
+    LabelWindow labels(fonts);
+    labels.show();
+    const Result_s before = run(frames, [&](int n, double t, bool split) { labels.frame(n, t, split); });
+    labels.hide();
+
+    GlyphWindow glyphs(fonts);
+    glyphs.show();
+    const Result_s after = run(frames, [&](int n, double t, bool split) { glyphs.frame(n, t, split); });
+    glyphs.hide();
+
+    LabelSplitTable labelTable(fonts, splits);
+    labelTable.show();
+    const Result_s labelSplits = runSplitTable(labelTable, splits);
+    labelTable.hide();
+
+    ViewSplitTable viewTable(fonts, splits);
+    viewTable.show();
+    const Result_s viewSplits = runSplitTable(viewTable, splits);
+
+    std::printf("frames: %d\n", frames);
+    std::printf("QLabel + stylesheet + rich text: %8.1f us/frame wall, %8.1f us/frame cpu\n", before.wallUs, before.cpuUs);
+    std::printf("GlyphLine:                       %8.1f us/frame wall, %8.1f us/frame cpu\n", after.wallUs, after.cpuUs);
+    std::printf("speedup (cpu): %.1fx\n", after.cpuUs > 0.0 ? before.cpuUs / after.cpuUs : 0.0);
+
+    std::printf("\nsplit table, %zu splits, %zu undos, reset:\n", splits + splits / 2, splits / 2);
+    std::printf("label rows rebuilt on scroll:    %8.1f us/op wall, %8.1f us/op cpu\n", labelSplits.wallUs, labelSplits.cpuUs);
+    std::printf("SplitTableView:                  %8.1f us/op wall, %8.1f us/op cpu\n", viewSplits.wallUs, viewSplits.cpuUs);
+    std::printf("speedup (cpu): %.1fx\n", viewSplits.cpuUs > 0.0 ? labelSplits.cpuUs / viewSplits.cpuUs : 0.0);
+    return 0;
+
+}
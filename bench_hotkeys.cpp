@@ -0,0 +1,198 @@
+#include <linux/uinput.h>
+#include <sys/ioctl.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <thread>
+
+import HotkeySource;
+import TimerEngine;
+import Instrumentation;
+
+// nxTimerBenchHotkeys: the evdev hotkey backend against a real kernel input device. Creates a virtual
+// keyboard through /dev/uinput, hands its event node to makeHotkeySource() in place of the scan of
+// /dev/input, and types on it. Checks that every bound key arrives once per press as the right input
+// with a kernel timestamp between the write and the poll, and that autorepeat, releases and unbound
+// keys never arrive. Then times [presses] presses from the write to the worker's poll() and from the
+// kernel's timestamp to the poll(). Needs write access to /dev/uinput and read access to the new node.
+//
+// usage: nxTimerBenchHotkeys [presses]
+
+static constexpr unsigned kVkF1 = 0x70;
+static constexpr int64_t kWaitNs = 1'000'000'000;
+
+static int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void printLatency(const char* what, const LatencyHistogram& h) {
+    std::printf("%-28s %10llu %10.2f %10.2f %10.2f %10.2f us\n", what, static_cast<unsigned long long>(h.count()),
+                h.percentile(0.50) / 1e3, h.percentile(0.99) / 1e3, h.percentile(0.999) / 1e3, h.max() / 1e3);
+}
+
+static bool emit(int fd, unsigned short type, unsigned short code, int value) {
+
+    input_event ev = {};
+    ev.type = type;
+    ev.code = code;
+    ev.value = value;
+    return write(fd, &ev, sizeof(ev)) == static_cast<ssize_t>(sizeof(ev));
+
+}
+
+// value: 1 press, 2 autorepeat, 0 release; each its own report, as a keyboard sends them
+static bool key(int fd, unsigned short code, int value) {
+    return emit(fd, EV_KEY, code, value) && emit(fd, EV_SYN, SYN_REPORT, 0);
+}
+
+// Spins on poll() the way the worker drains the ring, false if nothing came within 'timeoutNs'
+static bool waitKey(HotkeySource& source, KeyEvent_s& out, int64_t timeoutNs) {
+
+    const int64_t giveUp = nowNs() + timeoutNs;
+    while (!source.poll(out)) {
+        if (nowNs() > giveUp) return false;
+        std::this_thread::yield();
+    }
+    return true;
+
+}
+
+// The uinput device's /dev/input/event* node, empty if the kernel didn't give it one
+static std::string eventNode(int fd) {
+
+    char name[64] = {};
+    if (ioctl(fd, UI_GET_SYSNAME(sizeof(name)), name) < 0) return {};
+
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(std::string("/sys/devices/virtual/input/") + name, ec)) {
+        const std::string file = entry.path().filename().string();
+        if (file.rfind("event", 0) == 0) return "/dev/input/" + file;
+    }
+    return {};
+
+}
+
+int main(int argc, char** argv) {
+
+    const int presses = argc > 1 ? std::atoi(argv[1]) : 1000;
+    if (presses <= 0) {
+        std::fprintf(stderr, "usage: %s [presses]\n", argv[0]);
+        return 2;
+    }
+
+    const int fd = open("/dev/uinput", O_WRONLY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) {
+        std::printf("can't open /dev/uinput: %s (needs the uinput module and write access to it)\n", std::strerror(errno));
+        return 1;
+    }
+
+    // F1..F4 are bound, A is not
+    const unsigned short keys[] = { KEY_F1, KEY_F2, KEY_F3, KEY_F4, KEY_A };
+    bool ok = ioctl(fd, UI_SET_EVBIT, EV_KEY) == 0 && ioctl(fd, UI_SET_EVBIT, EV_SYN) == 0;
+    for (unsigned short code : keys) ok = ok && ioctl(fd, UI_SET_KEYBIT, code) == 0;
+
+    uinput_setup setup = {};
+    setup.id.bustype = BUS_VIRTUAL;
+    setup.id.vendor = 0x6e78;
+    setup.id.product = 0x0001;
+    std::strncpy(setup.name, "nxTimer test keyboard", UINPUT_MAX_NAME_SIZE - 1);
+    ok = ok && ioctl(fd, UI_DEV_SETUP, &setup) == 0 && ioctl(fd, UI_DEV_CREATE) == 0;
+    if (!ok) {
+        std::printf("can't create the uinput keyboard: %s\n", std::strerror(errno));
+        close(fd);
+        return 1;
+    }
+
+    const std::string node = eventNode(fd);
+    const HotkeyBindings_s bindings = { kVkF1, kVkF1 + 1, kVkF1 + 2, kVkF1 + 3 };
+    const std::unique_ptr<HotkeySource> source = makeHotkeySource({ node });
+
+    // udev creates the node and sets its permissions a moment after UI_DEV_CREATE
+    bool started = false;
+    for (int i = 0; i < 200 && !node.empty() && !(started = source->start(bindings)); ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    if (!started) {
+        std::printf("can't read the uinput keyboard at %s\n", node.empty() ? "(no event node)" : node.c_str());
+        ioctl(fd, UI_DEV_DESTROY);
+        close(fd);
+        return 1;
+    }
+
+    int failures = 0;
+    auto check = [&failures](bool passed, const char* what) {
+        std::printf("%-52s %s\n", what, passed ? "ok" : "FAILED");
+        if (!passed) ++failures;
+    };
+
+    KeyEvent_s event;
+
+    // every binding, one press each
+    struct { unsigned short code; uint8_t input; const char* what; } const bound[] = {
+        { KEY_F1, INPUT_RESET,       "reset press arrives as INPUT_RESET" },
+        { KEY_F2, INPUT_START_SPLIT, "start/split press arrives as INPUT_START_SPLIT" },
+        { KEY_F3, INPUT_SKIP,        "skip press arrives as INPUT_SKIP" },
+        { KEY_F4, INPUT_UNDO,        "undo press arrives as INPUT_UNDO" },
+    };
+    for (const auto& b : bound) {
+        const int64_t before = nowNs();
+        const bool sent = key(fd, b.code, 1);
+        const bool got = sent && waitKey(*source, event, kWaitNs);
+        const int64_t after = nowNs();
+        check(got && event.input == b.input && event.timestampNs >= before && event.timestampNs <= after, b.what);
+        key(fd, b.code, 0);
+    }
+
+    // a held key: one press, the repeats and the release must not arrive. The press of F1 that follows
+    // has to be the next thing the ring gives back.
+    key(fd, KEY_F2, 1);
+    for (int i = 0; i < 5; ++i) key(fd, KEY_F2, 2);
+    key(fd, KEY_F2, 0);
+    key(fd, KEY_A, 1);
+    key(fd, KEY_A, 0);
+    key(fd, KEY_F1, 1);
+    key(fd, KEY_F1, 0);
+    const bool held = waitKey(*source, event, kWaitNs) && event.input == INPUT_START_SPLIT;
+    const bool next = waitKey(*source, event, kWaitNs) && event.input == INPUT_RESET;
+    check(held, "held key arrives once");
+    check(next, "autorepeat, release and unbound keys are dropped");
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    check(!source->poll(event), "nothing left over");
+
+    // latency, press by press
+    static LatencyHistogram writeToPoll;
+    static LatencyHistogram kernelToPoll;
+    int lost = 0;
+    for (int i = 0; i < presses; ++i) {
+        const int64_t before = nowNs();
+        if (!key(fd, KEY_F2, 1) || !waitKey(*source, event, kWaitNs)) {
+            ++lost;
+        } else {
+            const int64_t seen = nowNs();
+            writeToPoll.record(static_cast<uint64_t>(seen - before));
+            kernelToPoll.record(static_cast<uint64_t>(std::max<int64_t>(0, seen - event.timestampNs)));
+        }
+        key(fd, KEY_F2, 0);
+    }
+    check(lost == 0, "every timed press arrives");
+
+    source->stop();
+    ioctl(fd, UI_DEV_DESTROY);
+    close(fd);
+
+    std::printf("%-28s %10s %10s %10s %10s %10s\n", "", "count", "p50", "p99", "p99.9", "max");
+    printLatency("write to poll", writeToPoll);
+    printLatency("kernel timestamp to poll", kernelToPoll);
+    std::printf("%s, %d presses\n", node.c_str(), presses);
+    return failures ? 1 : 0;
+
+}
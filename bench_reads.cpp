@@ -0,0 +1,241 @@
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+import GameAddresses;
+import MemorySource;
+import ReadPlanner;
+import GameMemory;
+import Instrumentation;
+
+// nxTimerBenchReads: what the read planner's cost model says a tick's field reads cost, against what
+// they really cost. The known builds' fields are laid out at their real offsets in stand-in module
+// images inside this process, and the OS backend the worker uses reads them from there. Each build's
+// planned ranges, the old fixed block and one range per field are read [iterations] times.
+//
+// Then the two read paths of a tick: the per-build one planned by the compiler and the generic one
+// the worker uses for scanned offsets, on a 32-bit image of the game served from memory, so only
+// what the paths themselves cost is left. Both have to produce the same snapshot.
+//
+// usage: nxTimerBenchReads [iterations]
+
+static int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static std::unique_ptr<MemorySource> selfMemorySource() {
+#ifdef _WIN32
+    return makeProcessMemorySource(GetCurrentProcess());
+#else
+    return makeProcessMemorySource(getpid());
+#endif
+}
+
+// Stand-ins for the three modules, big enough for every offset of every known layout
+struct FakeModules {
+
+    std::vector<unsigned char> xr3da       = std::vector<unsigned char>(0x120000);
+    std::vector<unsigned char> xrNetServer = std::vector<unsigned char>(0x20000);
+    std::vector<unsigned char> xrGame      = std::vector<unsigned char>(0x580000);
+
+    void install() const {
+        gameAddresses.baseAddr    = reinterpret_cast<uintptr_t>(xr3da.data());
+        gameAddresses.xrNetServer = reinterpret_cast<uintptr_t>(xrNetServer.data());
+        gameAddresses.xrGame      = reinterpret_cast<uintptr_t>(xrGame.data());
+        gameAddresses.ptrSize     = 4;
+    }
+
+};
+
+// The game as a 32-bit process: module images and a small heap for the End chain at fixed addresses,
+// served by copying out of them. Costs like the process backend, so both read paths plan alike.
+class ImageMemorySource final : public MemorySource {
+
+public:
+
+    struct Region {
+        uintptr_t                   base;
+        std::vector<unsigned char>  bytes;
+    };
+
+    static constexpr uintptr_t kXr3da       = 0x00400000;
+    static constexpr uintptr_t kXrNetServer = 0x10000000;
+    static constexpr uintptr_t kXrGame      = 0x20000000;
+    static constexpr uintptr_t kHeap        = 0x30000000;
+
+    explicit ImageMemorySource(const GameLayout_s& layout) {
+
+        regions.push_back({ kXr3da,       std::vector<unsigned char>(0x120000) });
+        regions.push_back({ kXrNetServer, std::vector<unsigned char>(0x20000)  });
+        regions.push_back({ kXrGame,      std::vector<unsigned char>(0x580000) });
+        regions.push_back({ kHeap,        std::vector<unsigned char>(0x1000)   });
+
+        // every link of the chain in its own 0x100 bytes of heap, the level name at the end
+        uintptr_t link = kXr3da + layout.endBase;
+        uintptr_t object = kHeap;
+        for (const uintptr_t offset : layout.endOffsets) {
+            write32(link, static_cast<uint32_t>(object));
+            link = object + offset;
+            object += 0x100;
+        }
+        std::memcpy(at(link), "l01_e", 5);
+
+    }
+
+    bool readScatter(ReadRequest_s* requests, size_t count) override {
+
+        syscalls.fetch_add(1, std::memory_order_relaxed);
+        bool allOk = true;
+        for (size_t i = 0; i < count; ++i) {
+            ReadRequest_s& r = requests[i];
+            const unsigned char* from = r.length ? at(r.address, r.length) : nullptr;
+            r.ok = from != nullptr;
+            if (from) std::memcpy(r.destination, from, r.length);
+            allOk &= r.ok;
+        }
+        return allOk;
+
+    }
+
+    ReadCostModel_s costModel() const override { return kProcessReadCostModel; }
+
+    static void install() {
+        gameAddresses.baseAddr    = kXr3da;
+        gameAddresses.xrNetServer = kXrNetServer;
+        gameAddresses.xrGame      = kXrGame;
+        gameAddresses.ptrSize     = 4;
+    }
+
+private:
+
+    unsigned char* at(uintptr_t address, size_t length = 1) {
+        for (Region& region : regions) {
+            if (address >= region.base && address - region.base + length <= region.bytes.size()) return region.bytes.data() + (address - region.base);
+        }
+        return nullptr;
+    }
+
+    void write32(uintptr_t address, uint32_t value) { std::memcpy(at(address, sizeof(value)), &value, sizeof(value)); }
+
+    std::vector<Region> regions;
+
+};
+
+static void measure(const char* name, const std::vector<PlannedRange_s>& ranges, double estimatedNs, MemorySource& source, int iterations) {
+
+    size_t bytes = 0;
+    for (const auto& r : ranges) bytes += r.length;
+
+    std::vector<unsigned char> buffer(bytes);
+    std::vector<ReadRequest_s> reads;
+    size_t offset = 0;
+    for (const auto& r : ranges) {
+        reads.push_back({ r.address, r.length, buffer.data() + offset });
+        offset += r.length;
+    }
+
+    for (int i = 0; i < iterations / 10; ++i) source.readScatter(reads.data(), reads.size()); // warm up
+
+    LatencyHistogram cost;
+    bool allOk = true;
+    for (int i = 0; i < iterations; ++i) {
+        const int64_t start = nowNs();
+        allOk &= source.readScatter(reads.data(), reads.size());
+        cost.record(static_cast<uint64_t>(nowNs() - start));
+    }
+
+    std::printf("  %-16s %6zu %8zu %10.0f %10llu %10.0f %8.2f%s\n", name, ranges.size(), bytes, estimatedNs,
+                static_cast<unsigned long long>(cost.percentile(0.50)), cost.mean(), cost.mean() / estimatedNs,
+                allOk ? "" : "  (reads failed)");
+
+}
+
+int main(int argc, char** argv) {
+
+    const int iterations = argc > 1 ? std::atoi(argv[1]) : 200'000;
+    if (iterations <= 0) {
+        std::fprintf(stderr, "usage: %s [iterations]\n", argv[0]);
+        return 2;
+    }
+
+    const FakeModules modules;
+    modules.install();
+
+    const struct { const char* name; const GameLayout_s& layout; GameVersion version; } builds[] = {
+        { "1.0000", layout10000, GAME_VERSION_1_0000 },
+        { "1.0006", layout10006, GAME_VERSION_1_0006 },
+    };
+
+    for (const auto& build : builds) {
+
+        attachLayout(selfMemorySource(), build.layout, build.version);
+        const ReadCostModel_s model = selfMemorySource()->costModel();
+
+        std::vector<PlannedRange_s> perField;
+        for (const auto& slice : versionOffsets.plan.slices) {
+            const PlannedRange_s& r = versionOffsets.plan.ranges[slice.rangeIndex];
+            perField.push_back({ r.address + (slice.bufferOffset - r.bufferOffset), slice.size, 0 });
+        }
+
+        std::printf("%s, model %.0f ns/call + %.0f ns/range + %.2f ns/byte\n", build.name, model.perScatterNs, model.perRangeNs, model.perByteNs);
+        std::printf("  %-16s %6s %8s %10s %10s %10s %8s\n", "reads", "ranges", "bytes", "estimate", "p50", "mean", "mean/est");
+
+        auto source = selfMemorySource();
+        measure("planned", versionOffsets.plan.ranges, versionOffsets.plan.estimatedCostNs, *source, iterations);
+        measure("fixed block", versionOffsets.fixedBlock, versionOffsets.fixedBlockCostNs, *source, iterations);
+        measure("one per field", perField, estimateReadCost(perField, model), *source, iterations);
+
+    }
+
+    detachGame();
+    std::printf("%d reads each, times in ns\n\n", iterations);
+
+    // Same number of calls for both paths in turns, best round of each
+    std::printf("read path, ns per tick (best of 5)\n");
+    std::printf("  %-8s %10s %10s %8s\n", "build", "per build", "generic", "ratio");
+
+    int mismatches = 0;
+    for (const auto& build : builds) {
+
+        ImageMemorySource::install();
+        attachLayout(std::make_unique<ImageMemorySource>(build.layout), build.layout, build.version);
+
+        const auto perBuild = build.version == GAME_VERSION_1_0000 ? readGameMemorySnapshotFor<layout10000>
+                                                                   : readGameMemorySnapshotFor<layout10006>;
+
+        perBuild();
+        const GameMemorySnapshot_s viaBuild = snapShotCurrent;
+        snapShotCurrent = {};
+        readGameMemorySnapshot();
+        if (std::memcmp(&viaBuild, &snapShotCurrent, sizeof(viaBuild)) != 0 || viaBuild.End[0] == 0) ++mismatches;
+
+        double bestBuild = 1e300;
+        double bestGeneric = 1e300;
+        for (int round = 0; round < 5; ++round) {
+            for (auto [read, best] : { std::pair{ perBuild, &bestBuild }, std::pair{ &readGameMemorySnapshot, &bestGeneric } }) {
+                const int64_t start = nowNs();
+                for (int i = 0; i < iterations; ++i) read();
+                *best = std::min(*best, static_cast<double>(nowNs() - start) / iterations);
+            }
+        }
+
+        std::printf("  %-8s %10.1f %10.1f %8.2f\n", build.name, bestBuild, bestGeneric, bestGeneric / bestBuild);
+
+    }
+
+    detachGame();
+    if (mismatches) std::printf("the read paths disagree on %d build(s)\n", mismatches);
+    return mismatches ? 1 : 0;
+
+}
@@ -0,0 +1,122 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <span>
+#include <thread>
+#include <vector>
+
+import TimerWorker;
+import Instrumentation;
+
+// nxTimerBenchSeqLock: [readers] threads call readTimerSnapshot() in a loop for [seconds] while this
+// thread publishes through the worker's publish path, flat out or at [rate] Hz. Every publish puts the
+// same counter into four fields of the snapshot, so a reader that ever sees them differ, or go back,
+// got a torn or stale copy. Prints per reader how many reads it made, how many copies the seqlock threw
+// away and retried, and how many were torn; and what a publish cost the writer.
+//
+// usage: nxTimerBenchSeqLock [readers] [seconds] [rate]
+
+struct alignas(64) ReaderStats_s {
+
+    uint64_t    reads       = 0;
+    uint64_t    retries     = 0;
+    uint64_t    torn        = 0;
+    uint64_t    backwards   = 0;
+
+};
+
+static int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void readLoop(const std::atomic<bool>& stop, ReaderStats_s& stats) {
+
+    int64_t last = 0;
+    while (!stop.load(std::memory_order_relaxed)) {
+
+        const TimerSnapshot_s s = readTimerSnapshot(&stats.retries);
+        ++stats.reads;
+
+        const int64_t n = s.accumulatedNs;
+        if (s.errorBoundNs != n || static_cast<int64_t>(s.currentSplitIndex) != n || s.publishedNs != n) ++stats.torn;
+        if (n < last) ++stats.backwards;
+        last = n;
+
+    }
+
+}
+
+int main(int argc, char** argv) {
+
+    const int readers = argc > 1 ? std::atoi(argv[1]) : 4;
+    const int seconds = argc > 2 ? std::atoi(argv[2]) : 5;
+    const int rate    = argc > 3 ? std::atoi(argv[3]) : 0;
+    if (readers <= 0 || readers > 256 || seconds <= 0 || rate < 0) {
+        std::fprintf(stderr, "usage: %s [readers] [seconds] [rate]\n", argv[0]);
+        return 2;
+    }
+
+    std::atomic<bool> stop{false};
+    std::vector<ReaderStats_s> stats(static_cast<size_t>(readers));
+    std::vector<std::thread> threads;
+    for (ReaderStats_s& s : stats) threads.emplace_back(readLoop, std::cref(stop), std::ref(s));
+
+    auto publishCost = std::make_unique<LatencyHistogram>();
+    TimerEngineState_s state;
+    state.timerRunning = true;
+
+    const auto interval = rate ? std::chrono::nanoseconds(1'000'000'000 / rate) : std::chrono::nanoseconds(0);
+    const auto end = std::chrono::steady_clock::now() + std::chrono::seconds(seconds);
+    auto next = std::chrono::steady_clock::now();
+    int64_t n = 0;
+
+    while (std::chrono::steady_clock::now() < end) {
+
+        if (rate) {
+            next += interval;
+            std::this_thread::sleep_until(next);
+        }
+
+        ++n;
+        state.accumulatedNs = n;
+        state.errorBoundNs = n;
+        state.currentSplitIndex = static_cast<size_t>(n);
+        state.previousTimestampNs = n;
+
+        const int64_t start = nowNs();
+        publishTimerState(state, {});
+        publishCost->record(static_cast<uint64_t>(nowNs() - start));
+
+    }
+
+    stop = true;
+    for (std::thread& t : threads) t.join();
+
+    std::printf("%-10s %14s %12s %10s %8s %8s\n", "reader", "reads", "retries", "retry %", "torn", "stale");
+    ReaderStats_s total;
+    for (size_t i = 0; i < stats.size(); ++i) {
+        const ReaderStats_s& s = stats[i];
+        std::printf("%-10zu %14llu %12llu %10.4f %8llu %8llu\n", i, static_cast<unsigned long long>(s.reads),
+                    static_cast<unsigned long long>(s.retries), s.reads ? 100.0 * s.retries / s.reads : 0.0,
+                    static_cast<unsigned long long>(s.torn), static_cast<unsigned long long>(s.backwards));
+        total.reads += s.reads;
+        total.retries += s.retries;
+        total.torn += s.torn;
+        total.backwards += s.backwards;
+    }
+    std::printf("%-10s %14llu %12llu %10.4f %8llu %8llu\n", "all", static_cast<unsigned long long>(total.reads),
+                static_cast<unsigned long long>(total.retries), total.reads ? 100.0 * total.retries / total.reads : 0.0,
+                static_cast<unsigned long long>(total.torn), static_cast<unsigned long long>(total.backwards));
+
+    std::printf("writer: %lld publishes (%s), p50 %llu ns, p99 %llu ns, p99.9 %llu ns, max %llu ns\n",
+                static_cast<long long>(n), rate ? "paced" : "flat out",
+                static_cast<unsigned long long>(publishCost->percentile(0.50)), static_cast<unsigned long long>(publishCost->percentile(0.99)),
+                static_cast<unsigned long long>(publishCost->percentile(0.999)), static_cast<unsigned long long>(publishCost->max()));
+
+    return total.torn || total.backwards ? 1 : 0;
+
+}
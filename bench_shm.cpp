@@ -0,0 +1,214 @@
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <spawn.h>
+#include <sys/wait.h>
+#endif
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <span>
+#include <string>
+#include <thread>
+
+#include "nxtimer_shm.h"
+
+import TimerWorker;
+import SharedState;
+import Instrumentation;
+
+// nxTimerBenchShm: how late another process sees what the worker publishes into the shared-memory
+// segment. This process publishes [ticks] ticks at [rate] Hz through the worker's own publish path,
+// with a split every 100 ticks, and starts a second copy of itself as the reader. The reader maps
+// the segment with nxtimer_shm.c, spins on the state version and times every state and event it sees
+// against the tick's timestamp. The writer reports what a publish costs the tick.
+//
+// usage: nxTimerBenchShm [ticks] [rate]
+
+static constexpr int kSplitEvery = 100;
+
+#ifndef _WIN32
+extern char** environ;
+#endif
+
+static int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void printLatency(const char* what, const LatencyHistogram& h) {
+    std::printf("%-28s %10llu %10.2f %10.2f %10.2f %10.2f us\n", what, static_cast<unsigned long long>(h.count()),
+                h.percentile(0.50) / 1e3, h.percentile(0.99) / 1e3, h.percentile(0.999) / 1e3, h.max() / 1e3);
+}
+
+static int runReader() {
+
+    nxtimer_reader reader;
+    const auto giveUp = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (nxtimer_open(&reader) != 0) {
+        if (std::chrono::steady_clock::now() > giveUp) {
+            std::printf("reader: no segment\n");
+            return 1;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    static LatencyHistogram stateLatency;
+    static LatencyHistogram eventLatency;
+    uint64_t lost = 0;
+    uint64_t torn = 0;
+    uint64_t version = nxtimer_state_version(&reader);
+    auto lastChange = std::chrono::steady_clock::now();
+
+    while (true) {
+
+        const uint64_t v = nxtimer_state_version(&reader);
+        if (v == version) {
+            if (std::chrono::steady_clock::now() - lastChange > std::chrono::seconds(5)) {
+                std::printf("reader: the writer stopped publishing\n");
+                break;
+            }
+            continue;
+        }
+        version = v;
+        lastChange = std::chrono::steady_clock::now();
+
+        nxtimer_state state;
+        if (!nxtimer_read_state(&reader, &state)) {
+            ++torn;
+            continue;
+        }
+        const int64_t seen = nxtimer_now_ns();
+        stateLatency.record(static_cast<uint64_t>(std::max<int64_t>(0, seen - state.tick_ns)));
+
+        nxtimer_event event;
+        for (int r; (r = nxtimer_next_event(&reader, &event)) != 0;) {
+            if (r < 0) {
+                ++lost;
+                continue;
+            }
+            eventLatency.record(static_cast<uint64_t>(std::max<int64_t>(0, nxtimer_now_ns() - event.timestamp_ns)));
+        }
+
+        if (state.finished) break;
+
+    }
+
+    nxtimer_close(&reader);
+
+    std::printf("%-28s %10s %10s %10s %10s %10s\n", "reader (other process)", "count", "p50", "p99", "p99.9", "max");
+    printLatency("state, tick to read", stateLatency);
+    printLatency("events, tick to read", eventLatency);
+    std::printf("lost events: %llu, unreadable states: %llu\n", static_cast<unsigned long long>(lost), static_cast<unsigned long long>(torn));
+    return lost || torn ? 1 : 0;
+
+}
+
+// Starts this executable again as the reader, false if that failed
+static bool spawnReader(const char* self, intptr_t& process) {
+
+#ifdef _WIN32
+    std::string command = std::string("\"") + self + "\" --reader";
+    STARTUPINFOA startup = {};
+    startup.cb = sizeof(startup);
+    PROCESS_INFORMATION info = {};
+    if (!CreateProcessA(nullptr, command.data(), nullptr, nullptr, FALSE, 0, nullptr, nullptr, &startup, &info)) return false;
+    CloseHandle(info.hThread);
+    process = reinterpret_cast<intptr_t>(info.hProcess);
+    return true;
+#else
+    char readerFlag[] = "--reader";
+    char* args[] = { const_cast<char*>(self), readerFlag, nullptr };
+    pid_t pid;
+    if (posix_spawnp(&pid, self, nullptr, nullptr, args, environ) != 0) return false;
+    process = pid;
+    return true;
+#endif
+
+}
+
+static int waitReader(intptr_t process) {
+
+#ifdef _WIN32
+    const HANDLE handle = reinterpret_cast<HANDLE>(process);
+    WaitForSingleObject(handle, INFINITE);
+    DWORD code = 1;
+    GetExitCodeProcess(handle, &code);
+    CloseHandle(handle);
+    return static_cast<int>(code);
+#else
+    int status = 0;
+    waitpid(static_cast<pid_t>(process), &status, 0);
+    return WIFEXITED(status) ? WEXITSTATUS(status) : 1;
+#endif
+
+}
+
+int main(int argc, char** argv) {
+
+    if (argc > 1 && std::strcmp(argv[1], "--reader") == 0) return runReader();
+
+    const int ticks = argc > 1 ? std::atoi(argv[1]) : 20'000;
+    const int rate = argc > 2 ? std::atoi(argv[2]) : 2000;
+    if (ticks <= 0 || rate <= 0) {
+        std::fprintf(stderr, "usage: %s [ticks] [rate]\n", argv[0]);
+        return 2;
+    }
+
+    if (!openSharedState()) {
+        std::printf("can't create the shared-memory segment %s\n", NXTIMER_SHM_NAME);
+        return 1;
+    }
+
+    intptr_t reader = 0;
+    if (!spawnReader(argv[0], reader)) {
+        std::printf("can't start the reader\n");
+        unlinkSharedState();
+        return 1;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(300)); // let it map the segment
+
+    static LatencyHistogram publishCost;
+    TimerEngineState_s state;
+    state.timerRunning = true;
+    state.gameTimePaused = false;
+    state.currentSplitIndex = 1;
+
+    const auto interval = std::chrono::nanoseconds(1'000'000'000 / rate);
+    auto next = std::chrono::steady_clock::now();
+
+    for (int i = 1; i <= ticks; ++i) {
+
+        next += interval;
+        std::this_thread::sleep_until(next);
+
+        const int64_t now = nowNs();
+        state.accumulatedNs += interval.count();
+        state.previousTimestampNs = now;
+
+        TimerEvent_s events[1];
+        size_t eventCount = 0;
+        if (i == ticks) {
+            state.timerRunning = false;
+            state.displayTotal = true;
+            events[eventCount++] = { EVENT_FINAL, ++state.currentSplitIndex, state.accumulatedNs, now, 0 };
+        } else if (i % kSplitEvery == 0) {
+            events[eventCount++] = { EVENT_SPLIT, ++state.currentSplitIndex, state.accumulatedNs, now, 0 };
+        }
+
+        publishTimerState(state, std::span<const TimerEvent_s>(events, eventCount));
+        publishCost.record(static_cast<uint64_t>(nowNs() - now));
+
+    }
+
+    const int readerResult = waitReader(reader);
+    unlinkSharedState();
+
+    std::printf("%-28s %10s %10s %10s %10s %10s\n", "writer", "count", "p50", "p99", "p99.9", "max");
+    printLatency("publish (worker's cost)", publishCost);
+    std::printf("%d ticks at %d Hz\n", ticks, rate);
+    return readerResult;
+
+}
@@ -0,0 +1,266 @@
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+import TimerWorker;
+import StateServer;
+
+// nxTimerBenchStateServer: the state server over real loopback sockets. Starts it on [port] (a free one
+// by default), publishes timer states and events through the worker's publish path and connects as
+// overlays would. Checks the /events response head, that the first message is the full published
+// state, /state, that the 65th client is turned away while 64 are streaming and let in once one
+// leaves, and that a client which stops reading is dropped once its backlog overflows while a client
+// that keeps reading gets the whole stream.
+//
+// usage: nxTimerBenchStateServer [port]
+
+#ifdef _WIN32
+using Socket = SOCKET;
+static constexpr Socket kNoSocket = INVALID_SOCKET;
+static int pollSockets(pollfd* fds, size_t n, int timeoutMs) { return WSAPoll(fds, static_cast<ULONG>(n), timeoutMs); }
+static void closeSocket(Socket s) { closesocket(s); }
+#else
+using Socket = int;
+static constexpr Socket kNoSocket = -1;
+static int pollSockets(pollfd* fds, size_t n, int timeoutMs) { return poll(fds, static_cast<nfds_t>(n), timeoutMs); }
+static void closeSocket(Socket s) { close(s); }
+#endif
+
+static constexpr size_t kMaxClients = 64;           // StateServer's limits
+static constexpr size_t kMaxBacklog = 256 * 1024;
+
+// What the kernel may still take for a client that doesn't read, on top of the server's backlog: loopback
+// send buffers autotune to a few MB (tcp_wmem on Linux), the client's receive buffer is kept small
+static constexpr size_t kSocketBuffers = 6 << 20;
+
+static int failures = 0;
+
+static void check(bool passed, const char* what) {
+    std::printf("%-60s %s\n", what, passed ? "ok" : "FAILED");
+    if (!passed) ++failures;
+}
+
+static sockaddr_in loopback(uint16_t port) {
+
+    sockaddr_in address = {};
+    address.sin_family      = AF_INET;
+    address.sin_port        = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    return address;
+
+}
+
+// A port nothing listens on right now, 0 if the OS wouldn't say
+static uint16_t freePort() {
+
+    const Socket s = socket(AF_INET, SOCK_STREAM, 0);
+    if (s == kNoSocket) return 0;
+    sockaddr_in address = loopback(0);
+    socklen_t size = sizeof(address);
+    const bool ok = bind(s, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0 &&
+                    getsockname(s, reinterpret_cast<sockaddr*>(&address), &size) == 0;
+    closeSocket(s);
+    return ok ? ntohs(address.sin_port) : 0;
+
+}
+
+// Connects and sends 'request'; 'receiveBuffer' > 0 shrinks the socket's receive buffer first
+static Socket connectTo(uint16_t port, std::string_view request, int receiveBuffer = 0) {
+
+    const Socket s = socket(AF_INET, SOCK_STREAM, 0);
+    if (s == kNoSocket) return kNoSocket;
+    if (receiveBuffer > 0) setsockopt(s, SOL_SOCKET, SO_RCVBUF, reinterpret_cast<const char*>(&receiveBuffer), sizeof(receiveBuffer));
+
+    const sockaddr_in address = loopback(port);
+    if (connect(s, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 ||
+        send(s, request.data(), static_cast<int>(request.size()), 0) != static_cast<int>(request.size())) {
+        closeSocket(s);
+        return kNoSocket;
+    }
+    return s;
+
+}
+
+// Appends what arrives within 'timeoutMs' to 'out'. False once the server closed the connection.
+static bool receiveFor(Socket s, std::string& out, int timeoutMs) {
+
+    pollfd fd = { s, POLLIN, 0 };
+    if (pollSockets(&fd, 1, timeoutMs) <= 0) return true;
+
+    char buffer[16384];
+    const auto n = recv(s, buffer, sizeof(buffer), 0);
+    if (n <= 0) return false;
+    out.append(buffer, static_cast<size_t>(n));
+    return true;
+
+}
+
+// Reads until 'out' holds 'count' of 'marker' or 'timeoutMs' passed, false if it never did
+static bool receiveUntil(Socket s, std::string& out, std::string_view marker, int count, int timeoutMs) {
+
+    const auto giveUp = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    while (true) {
+        int found = 0;
+        for (size_t at = out.find(marker); at != std::string::npos; at = out.find(marker, at + marker.size())) ++found;
+        if (found >= count) return true;
+        if (std::chrono::steady_clock::now() > giveUp || !receiveFor(s, out, 10)) return false;
+    }
+
+}
+
+// True if the server closes the connection within 'timeoutMs'. Reads whatever was still on its way,
+// into 'bytes' if given.
+static bool closedWithin(Socket s, int timeoutMs, size_t* bytes = nullptr) {
+
+    const auto giveUp = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    std::string pending;
+    size_t total = 0;
+    bool closed = false;
+    while (!closed && std::chrono::steady_clock::now() < giveUp) {
+        closed = !receiveFor(s, pending, 10);
+        total += pending.size();
+        pending.clear();
+    }
+    if (bytes) *bytes = total;
+    return closed;
+
+}
+
+int main(int argc, char** argv) {
+
+    const int requested = argc > 1 ? std::atoi(argv[1]) : 0;
+    if (requested < 0 || requested > 65535) {
+        std::fprintf(stderr, "usage: %s [port]\n", argv[0]);
+        return 2;
+    }
+
+    // Winsock has to be up before freePort(); the server starts it again for itself
+#ifdef _WIN32
+    WSADATA wsa;
+    WSAStartup(MAKEWORD(2, 2), &wsa);
+#endif
+
+    const uint16_t port = requested ? static_cast<uint16_t>(requested) : freePort();
+    if (!port || !startStateServer(port)) {
+        std::printf("can't listen on 127.0.0.1:%u\n", port);
+        return 1;
+    }
+
+    // a known state for the first message, left for a couple of flushes so the server has taken it
+    TimerEngineState_s state;
+    state.timerRunning = true;
+    state.gameTimePaused = false;
+    state.currentSplitIndex = 3;
+    state.accumulatedNs = 123'456'789;
+    state.errorBoundNs = 500'000;
+    publishTimerState(state, {});
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    const std::string_view eventsRequest = "GET /events HTTP/1.1\r\nHost: 127.0.0.1\r\nAccept: text/event-stream\r\n\r\n";
+
+    // response head and the first message
+    const Socket reader = connectTo(port, eventsRequest);
+    std::string stream;
+    const bool gotFirst = reader != kNoSocket && receiveUntil(reader, stream, "\n\n", 2, 2000); // retry, state
+    const size_t bodyAt = stream.find("\r\n\r\n");
+    const std::string_view head = std::string_view(stream).substr(0, bodyAt == std::string::npos ? 0 : bodyAt + 2);
+    const std::string_view body = std::string_view(stream).substr(bodyAt == std::string::npos ? stream.size() : bodyAt + 4);
+
+    check(gotFirst && head.starts_with("HTTP/1.1 200 OK\r\n"), "/events answers 200");
+    check(head.find("\r\nContent-Type: text/event-stream\r\n") != std::string_view::npos, "/events is text/event-stream");
+    check(head.find("\r\nCache-Control: no-cache\r\n") != std::string_view::npos, "/events is not cached");
+    check(head.find("\r\nAccess-Control-Allow-Origin: *\r\n") != std::string_view::npos, "/events is open to browser sources");
+    check(body.starts_with("retry: 1000\n\n"
+                           "event: state\ndata: {\"split\":3,\"running\":true,\"paused\":false,\"finished\":false,"
+                           "\"time_ns\":123456789,\"error_ns\":500000}\n\n"), "first message is the full state");
+    stream.clear();
+
+    // /state, once
+    const Socket once = connectTo(port, "GET /state HTTP/1.1\r\nHost: 127.0.0.1\r\n\r\n");
+    std::string answer;
+    bool closed = false;
+    for (auto giveUp = std::chrono::steady_clock::now() + std::chrono::seconds(2); once != kNoSocket && !closed && std::chrono::steady_clock::now() < giveUp;) {
+        closed = !receiveFor(once, answer, 10);
+    }
+    if (once != kNoSocket) closeSocket(once);
+    check(closed && answer.starts_with("HTTP/1.1 200 OK\r\n") &&
+          answer.ends_with("\r\n\r\n{\"split\":3,\"running\":true,\"paused\":false,\"finished\":false,\"time_ns\":123456789,\"error_ns\":500000}"),
+          "/state answers the full state and closes");
+
+    // the client cap: 'reader' and 63 more stream, the next one is closed unanswered
+    std::vector<Socket> crowd;
+    bool allAnswered = true;
+    for (size_t i = 1; i < kMaxClients; ++i) {
+        const Socket s = connectTo(port, eventsRequest);
+        std::string response;
+        allAnswered = allAnswered && s != kNoSocket && receiveUntil(s, response, "\r\n\r\n", 1, 2000) && response.starts_with("HTTP/1.1 200 OK");
+        crowd.push_back(s);
+    }
+    check(allAnswered, "64 clients stream at once");
+
+    const Socket extra = connectTo(port, eventsRequest);
+    check(extra == kNoSocket || closedWithin(extra, 2000), "the 65th client is closed");
+    if (extra != kNoSocket) closeSocket(extra);
+
+    closeSocket(crowd.back());
+    crowd.pop_back();
+    std::this_thread::sleep_for(std::chrono::milliseconds(200)); // the server sees the hangup on its next poll
+    const Socket late = connectTo(port, eventsRequest);
+    std::string lateResponse;
+    check(late != kNoSocket && receiveUntil(late, lateResponse, "\r\n\r\n", 1, 2000) && lateResponse.starts_with("HTTP/1.1 200 OK"),
+          "a client gets in once one has left");
+    crowd.push_back(late);
+
+    for (Socket s : crowd) if (s != kNoSocket) closeSocket(s);
+    crowd.clear();
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    // backlog overflow: 'stalled' never reads, 'reader' keeps up. Events go out until 'reader' has seen
+    // more than the backlog and every socket buffer on the way to 'stalled' can hold.
+    const Socket stalled = connectTo(port, eventsRequest, 4096);
+    std::string stalledResponse;
+    check(stalled != kNoSocket && receiveUntil(stalled, stalledResponse, "\r\n\r\n", 1, 2000), "a client that will stop reading is answered");
+
+    size_t streamed = 0;
+    bool readerAlive = true;
+    TimerEvent_s events[16];
+    const auto giveUp = std::chrono::steady_clock::now() + std::chrono::seconds(60);
+    while (readerAlive && streamed < kMaxBacklog + kSocketBuffers && std::chrono::steady_clock::now() < giveUp) {
+
+        for (TimerEvent_s& e : events) e = { EVENT_SPLIT, ++state.currentSplitIndex, state.accumulatedNs, 0, 0 };
+        state.accumulatedNs += 1'000'000;
+        publishTimerState(state, std::span<const TimerEvent_s>(events));
+
+        readerAlive = receiveFor(reader, stream, 2);
+        streamed += stream.size();
+        stream.clear();
+
+    }
+    check(readerAlive && streamed >= kMaxBacklog + kSocketBuffers, "a client that reads gets the whole stream");
+
+    size_t queued = 0;
+    check(stalled != kNoSocket && closedWithin(stalled, 5000, &queued) && queued < streamed, "a client that stops reading is dropped");
+    std::printf("%zu bytes streamed, %zu bytes were still on their way to the dropped client\n", streamed, stalledResponse.size() + queued);
+
+    if (stalled != kNoSocket) closeSocket(stalled);
+    closeSocket(reader);
+    stopStateServer();
+    return failures ? 1 : 0;
+
+}
@@ -0,0 +1,142 @@
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <span>
+#include <string>
+#include <string_view>
+
+import TimeFormat;
+
+// nxTimerBenchTime: first sweeps whole runs through every format at every precision the timer uses,
+// one displayed step at a time, and checks each text parses back to the value it shows. Then times
+// formatting and parsing against the double based code they replaced (std::pow/std::floor and
+// std::stod with exceptions; the GUI built QStrings on top of that).
+//
+// usage: nxTimerBenchTime [iterations]
+
+static volatile uint64_t keep; // results go here, so the timed loops can't be optimized away
+
+using Formatter = size_t (*)(Duration, int, std::span<char, kDurationTextMax>);
+
+// Every step from 'begin' to 'end', plus a value inside the step from a cheap LCG
+static uint64_t sweep(const char* name, Formatter format, int precision, Duration begin, Duration end, bool keepsSign) {
+
+    const int64_t unit = Duration::unitOf(precision);
+    uint64_t checked = 0;
+    uint64_t lcg = 0x9E3779B97F4A7C15ull;
+
+    for (int64_t ns = begin.ns(); ns <= end.ns(); ns += unit) {
+
+        lcg = lcg * 6364136223846793005ull + 1442695040888963407ull;
+        for (const int64_t offset : { int64_t{0}, static_cast<int64_t>((lcg >> 33) % static_cast<uint64_t>(unit)) }) {
+
+            const Duration d = Duration::fromNs(ns + offset);
+            char text[kDurationTextMax];
+            const std::string_view written(text, format(d, precision, std::span<char, kDurationTextMax>(text)));
+
+            Duration parsed;
+            if (written == "+" || written == "-") parsed = Duration();
+            else if (!parseDuration(written, parsed)) parsed = Duration::fromNs(INT64_MIN);
+
+            const Duration expected = keepsSign ? d.truncated(precision) : d.truncated(precision).abs();
+            if (parsed != expected) {
+                std::printf("%s: %lld ns at precision %d wrote \"%.*s\", read back %lld ns\n", name, static_cast<long long>(d.ns()),
+                            precision, static_cast<int>(written.size()), written.data(), static_cast<long long>(parsed.ns()));
+                std::exit(1);
+            }
+            ++checked;
+
+        }
+
+    }
+    return checked;
+
+}
+
+// What GUIFrame did before, with std::string where it had QString
+static std::string oldFormatTime(double seconds, int precision) {
+
+    const double factor = std::pow(10.0, precision);
+    const double truncated = std::floor(seconds * factor) / factor;
+    const int totalSeconds = static_cast<int>(truncated);
+    char fraction[32];
+    std::snprintf(fraction, sizeof(fraction), "%.*f", precision, truncated - totalSeconds);
+    char text[64];
+    std::snprintf(text, sizeof(text), "%d:%02d%s", totalSeconds / 60, totalSeconds % 60, fraction + 1);
+    return text;
+
+}
+
+static std::string oldFormatCompact(double seconds, int precision) {
+
+    const double absSeconds = std::abs(seconds);
+    const double factor = std::pow(10.0, precision);
+    const double t = std::floor(absSeconds * factor) / factor;
+    if (absSeconds >= 60.0) return oldFormatTime(t, precision);
+    char text[64];
+    std::snprintf(text, sizeof(text), "%.*f", precision, t);
+    return text;
+
+}
+
+static bool oldParse(const std::string& t, double& outSeconds) {
+
+    if (t.empty() || t == "-") return false;
+    try {
+        const auto colonPos = t.find(':');
+        if (colonPos == std::string::npos) {
+            outSeconds = std::stod(t);
+            return true;
+        }
+        outSeconds = std::stod(t.substr(0, colonPos)) * 60.0 + std::stod(t.substr(colonPos + 1));
+        return true;
+    } catch (...) {
+        return false;
+    }
+
+}
+
+template <class F>
+static double nsPerCall(int iterations, F&& f) {
+
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) f(i);
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / iterations;
+
+}
+
+int main(int argc, char** argv) {
+
+    const int iterations = argc > 1 ? std::atoi(argv[1]) : 2'000'000;
+
+    uint64_t checked = 0;
+    checked += sweep("compact", formatDurationCompact, 3, Duration(), Duration::fromSeconds(2 * 3600), false);
+    checked += sweep("compact", formatDurationCompact, 2, Duration(), Duration::fromSeconds(24 * 3600), false);
+    checked += sweep("compact", formatDurationCompact, 1, Duration(), Duration::fromSeconds(24 * 3600), false);
+    checked += sweep("clock", formatDuration, 3, Duration::fromSeconds(-3600), Duration::fromSeconds(3600), true);
+    checked += sweep("clock", formatDuration, 0, Duration(), Duration::fromSeconds(100 * 3600), true);
+    checked += sweep("delta", formatDelta, 3, Duration::fromSeconds(-3600), Duration::fromSeconds(3600), true);
+    std::printf("round trips: %llu values, all exact\n", static_cast<unsigned long long>(checked));
+
+    // a run's worth of different values, so neither side gets to cache anything
+    const auto valueAt = [](int i) { return Duration::fromNs((static_cast<int64_t>(i) * 7'919'000'117) % (3 * 3600 * Duration::kNsPerSecond)); };
+
+    uint64_t sink = 0;
+    const double oldFormat = nsPerCall(iterations, [&](int i) { sink += oldFormatCompact(valueAt(i).seconds(), 2).size(); });
+    const double newFormat = nsPerCall(iterations, [&](int i) {
+        char text[kDurationTextMax];
+        sink += formatDurationCompact(valueAt(i), 2, text);
+    });
+
+    const std::string texts[] = { "1:36.5", "54.1", "1:02.7", "20.3", "59.8", "1:18.9", "-", "" };
+    const double oldRead = nsPerCall(iterations, [&](int i) { double s = 0.0; sink += oldParse(texts[i % 8], s); });
+    const double newRead = nsPerCall(iterations, [&](int i) { Duration d; sink += parseDuration(texts[i % 8], d); });
+
+    std::printf("format (compact, 2 decimals): %8.1f ns double + std::string, %8.1f ns Duration, %.1fx\n", oldFormat, newFormat, oldFormat / newFormat);
+    std::printf("parse (splits_table times):   %8.1f ns std::stod,           %8.1f ns Duration, %.1fx\n", oldRead, newRead, oldRead / newRead);
+    keep = sink;
+    return 0;
+
+}
@@ -0,0 +1,354 @@
+#include <QApplication>
+#include <QCoreApplication>
+#include <QEvent>
+#include <QObject>
+#include <QString>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <span>
+#include <string>
+#include <vector>
+
+import GUIFrame;
+import TimerWorker;
+import Settings;
+import Instrumentation;
+
+// nxTimerBenchWindow: the timer window itself (GridWidget) on Qt's offscreen platform, fed scripted
+// timer states through the worker's publication instead of a game. Each scenario runs frame by frame:
+// updateDisplay() first, then the posted repaints it caused. Per frame it measures the GUI thread's CPU
+// time and heap allocations for both, and prints one JSON line per scenario for tracking over time.
+//
+// Scenarios, on a splits_table of [splits] rows:
+//   idle          stopped at zero, nothing changes
+//   running       time counting, no events
+//   rapid_splits  a split every frame, a reset after the last one
+//   undo_storm    bursts of undos and re-splits around the middle of the table
+//   full_route    every split at an even pace through the frames, then a reset
+//
+// usage: nxTimerBenchWindow [frames] [splits]
+
+static constexpr int64_t kFrameNs = 16'666'667;  // the time a frame adds while counting, 60 Hz
+static constexpr size_t  kStormSize = 10;        // undos in one burst, then as many splits
+
+// Heap allocations made on this thread. Qt's containers allocate with malloc, so on glibc malloc
+// itself is replaced (operator new ends up there too). Elsewhere only operator new is counted.
+static thread_local uint64_t allocations = 0;
+
+#if defined(__GLIBC__)
+
+static constexpr const char* kAllocHook = "malloc";
+
+extern "C" {
+
+void* __libc_malloc(size_t);
+void* __libc_calloc(size_t, size_t);
+void* __libc_realloc(void*, size_t);
+void  __libc_free(void*);
+
+void* malloc(size_t n) noexcept { ++allocations; return __libc_malloc(n); }
+void* calloc(size_t n, size_t size) noexcept { ++allocations; return __libc_calloc(n, size); }
+void* realloc(void* p, size_t n) noexcept { ++allocations; return __libc_realloc(p, n); }
+void  free(void* p) noexcept { __libc_free(p); }
+
+}
+
+#else
+
+static constexpr const char* kAllocHook = "operator new";
+
+void* operator new(size_t n) {
+    ++allocations;
+    if (void* p = std::malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](size_t n) { return operator new(n); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+
+#endif
+
+// Paint events delivered to any widget, to tell frames that repainted from frames that didn't
+class PaintCounter : public QObject {
+
+public:
+
+    uint64_t paints = 0;
+
+protected:
+
+    bool eventFilter(QObject* watched, QEvent* event) override {
+        if (event->type() == QEvent::Paint) ++paints;
+        return QObject::eventFilter(watched, event);
+    }
+
+};
+
+// A timer driven by the script instead of the engine. Events carry the index after them, like the engine's.
+class ScriptedTimer {
+
+public:
+
+    explicit ScriptedTimer(size_t splits) : splits(splits) {}
+
+    size_t index() const { return state.currentSplitIndex; }
+
+    void start() {
+        state.timerRunning = true;
+        state.gameTimePaused = false;
+        state.currentSplitIndex = 1;
+        push(EVENT_START);
+    }
+
+    void advance() {
+        state.previousTimestampNs += kFrameNs;
+        if (state.timerRunning && !state.gameTimePaused) state.accumulatedNs += kFrameNs;
+    }
+
+    void split() {
+        if (state.currentSplitIndex > splits) return;
+        ++state.currentSplitIndex;
+        push(state.currentSplitIndex > splits ? EVENT_FINAL : EVENT_SPLIT);
+        if (state.currentSplitIndex > splits) state.timerRunning = false;
+    }
+
+    void undo() {
+        if (state.currentSplitIndex <= 1) return;
+        --state.currentSplitIndex;
+        state.timerRunning = true;
+        push(EVENT_UNDO);
+    }
+
+    void reset() {
+        state.timerRunning = false;
+        state.gameTimePaused = true;
+        state.currentSplitIndex = 0;
+        state.accumulatedNs = 0;
+        push(EVENT_RESET);
+    }
+
+    void publish() {
+        publishTimerState(state, events);
+        events.clear();
+    }
+
+private:
+
+    void push(TimerEventKind kind) {
+        events.push_back({ kind, state.currentSplitIndex, state.accumulatedNs, state.previousTimestampNs, 0 });
+    }
+
+    size_t                      splits;
+    TimerEngineState_s          state;
+    std::vector<TimerEvent_s>   events;
+
+};
+
+struct Cost_s {
+
+    LatencyHistogram    cpuNs;
+    uint64_t            allocs      = 0;
+    uint64_t            maxAllocs   = 0;
+
+    void add(int64_t ns, uint64_t n) {
+        cpuNs.record(static_cast<uint64_t>(ns > 0 ? ns : 0));
+        allocs += n;
+        maxAllocs = std::max(maxAllocs, n);
+    }
+
+};
+
+struct Scenario_s {
+
+    uint64_t    frames          = 0;
+    uint64_t    paintedFrames   = 0;
+    uint64_t    paintEvents     = 0;
+    Cost_s      update;         // every frame
+    Cost_s      paint;          // frames that repainted anything
+
+};
+
+class Bench {
+
+public:
+
+    Bench(GridWidget& window, PaintCounter& counter) : window(window), counter(counter) {}
+
+    // One frame: the script changes the timer, the window picks it up, the repaints it posted run
+    void frame(ScriptedTimer& timer, Scenario_s& out) {
+
+        timer.publish();
+
+        uint64_t allocs = allocations;
+        int64_t cpu = threadCpuTimeNs();
+        window.updateDisplay();
+        out.update.add(threadCpuTimeNs() - cpu, allocations - allocs);
+
+        // only the repaint requests: timers and other queued work stay out of the measurement
+        const uint64_t paints = counter.paints;
+        allocs = allocations;
+        cpu = threadCpuTimeNs();
+        QCoreApplication::sendPostedEvents(nullptr, QEvent::UpdateRequest);
+        const int64_t paintNs = threadCpuTimeNs() - cpu;
+        const uint64_t paintAllocs = allocations - allocs;
+
+        ++out.frames;
+        if (counter.paints != paints) {
+            ++out.paintedFrames;
+            out.paintEvents += counter.paints - paints;
+            out.paint.add(paintNs, paintAllocs);
+        }
+
+    }
+
+    // Everything the last scenario left behind, unmeasured
+    void settle() {
+        for (int i = 0; i < 3; ++i) QApplication::processEvents();
+    }
+
+private:
+
+    GridWidget&     window;
+    PaintCounter&   counter;
+
+};
+
+static std::string costJson(const Cost_s& c, uint64_t n) {
+
+    char text[256];
+    std::snprintf(text, sizeof(text),
+                  "{\"cpu_ns\":{\"mean\":%.0f,\"p50\":%llu,\"p99\":%llu,\"max\":%llu},\"allocs\":{\"mean\":%.2f,\"max\":%llu}}",
+                  c.cpuNs.mean(), static_cast<unsigned long long>(c.cpuNs.percentile(0.50)),
+                  static_cast<unsigned long long>(c.cpuNs.percentile(0.99)), static_cast<unsigned long long>(c.cpuNs.max()),
+                  n ? static_cast<double>(c.allocs) / n : 0.0, static_cast<unsigned long long>(c.maxAllocs));
+    return text;
+
+}
+
+static void report(const char* name, size_t splits, const Scenario_s& s) {
+
+    std::printf("{\"bench\":\"window\",\"scenario\":\"%s\",\"qt\":\"%s\",\"platform\":\"%s\",\"alloc_hook\":\"%s\","
+                "\"splits\":%zu,\"frames\":%llu,\"painted_frames\":%llu,\"paint_events\":%llu,\"update\":%s,\"paint\":%s}\n",
+                name, qVersion(), qPrintable(QApplication::platformName()), kAllocHook, splits,
+                static_cast<unsigned long long>(s.frames), static_cast<unsigned long long>(s.paintedFrames),
+                static_cast<unsigned long long>(s.paintEvents),
+                costJson(s.update, s.frames).c_str(), costJson(s.paint, s.paintedFrames).c_str());
+    std::fflush(stdout);
+
+}
+
+// The settings GridWidget is built from: segment timer, split table with deltas against every row
+static std::string benchSettings(size_t splits) {
+
+    std::string text = "category: Bench;segment_time: ON;show_splits: ON;splits_total: OFF;two_decimal_points: ON;"
+                       "display_rate: 60;splits_table: [";
+    for (size_t i = 0; i < splits; ++i) {
+        const size_t seconds = 45 + (i * 37) % 120;
+        text += (i ? ", Split " : "Split ") + std::to_string(i + 1) + " = " + std::to_string(seconds / 60) + ":"
+              + (seconds % 60 < 10 ? "0" : "") + std::to_string(seconds % 60) + ".500";
+    }
+    return text + "];";
+
+}
+
+int main(int argc, char** argv) {
+
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) qputenv("QT_QPA_PLATFORM", "offscreen");
+    QApplication app(argc, argv);
+
+    const uint64_t frames = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 3000;
+    const size_t splits = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 150;
+    if (!frames || !splits) {
+        std::fprintf(stderr, "usage: nxTimerBenchWindow [frames] [splits]\n");
+        return 1;
+    }
+
+    setupSettings(benchSettings(splits));
+
+    PaintCounter counter;
+    app.installEventFilter(&counter);
+
+    GridWidget window;
+    setTimerEventNotifier({}); // the bench refreshes the window itself, once per frame
+    window.show();
+
+    Bench bench(window, counter);
+    bench.settle();
+
+    {
+        ScriptedTimer timer(splits);
+        Scenario_s s;
+        for (uint64_t n = 0; n < frames; ++n) bench.frame(timer, s);
+        report("idle", splits, s);
+        bench.settle();
+    }
+
+    {
+        ScriptedTimer timer(splits);
+        timer.start();
+        Scenario_s s;
+        for (uint64_t n = 0; n < frames; ++n) { timer.advance(); bench.frame(timer, s); }
+        report("running", splits, s);
+        timer.reset();
+        timer.publish();
+        bench.settle();
+    }
+
+    {
+        ScriptedTimer timer(splits);
+        timer.start();
+        Scenario_s s;
+        for (uint64_t n = 0; n < frames; ++n) {
+            timer.advance();
+            if (timer.index() > splits) { timer.reset(); timer.start(); }
+            else timer.split();
+            bench.frame(timer, s);
+        }
+        report("rapid_splits", splits, s);
+        timer.reset();
+        timer.publish();
+        bench.settle();
+    }
+
+    {
+        // into the middle of the table first, so the bursts scroll it both ways
+        ScriptedTimer timer(splits);
+        timer.start();
+        while (timer.index() < splits / 2 + 1) { timer.advance(); timer.split(); timer.publish(); window.updateDisplay(); }
+        bench.settle();
+
+        Scenario_s s;
+        for (uint64_t n = 0; n < frames; ++n) {
+            timer.advance();
+            for (size_t k = 0; k < kStormSize; ++k) n % 2 ? timer.split() : timer.undo();
+            bench.frame(timer, s);
+        }
+        report("undo_storm", splits, s);
+        timer.reset();
+        timer.publish();
+        bench.settle();
+    }
+
+    {
+        ScriptedTimer timer(splits);
+        timer.start();
+        const uint64_t every = std::max<uint64_t>(1, frames / (splits + 1));
+        Scenario_s s;
+        for (uint64_t n = 0; n < frames; ++n) {
+            timer.advance();
+            if (timer.index() > splits) { timer.reset(); timer.start(); }
+            else if (n % every == every - 1) timer.split();
+            bench.frame(timer, s);
+        }
+        report("full_route", splits, s);
+    }
+
+    return 0;
+
+}
@@ -1,23 +1,75 @@
 #include <QApplication>
 #include <thread>
+#include <string>
+#include <fstream>
+#include <cstdint>
 
 import Settings;
 import GameMemory;
 import TimerWorker;
 import GUIFrame;
+import PerfTracer;
+import TimeFormat;
+import StateServer;
+import SharedState;
+
+// m:ss.fff, as the Total line shows it
+static std::string clockText(Duration d) {
+    char text[kDurationTextMax];
+    return std::string(text, formatDuration(d, 3, text));
+}
+
+// nxTimer --replay <trace.nxtrace>: re-simulates a recorded run without the game and writes
+// the result next to the trace as <trace>.txt
+static int runReplay(const std::string& tracePath) {
+
+    const ReplayResult_s result = replayTrace(tracePath);
+    if (!result.ok) return 1;
+
+    std::ofstream out(tracePath + ".txt");
+    out << "records: "       << result.records      << "\n"
+        << "trace seconds: " << result.traceSeconds << "\n"
+        << "wall seconds: "  << result.wallSeconds  << "\n"
+        << "final time: "    << clockText(result.finalTime) << "\n"
+        << "final time error bound ms: " << result.finalErrorMs << "\n"
+        << "load boundaries: " << result.boundaries << ", worst error bound ms: " << result.worstBoundaryMs << "\n";
+
+    // adaptive polling vs. polling at the ceiling the whole time
+    out << "ticks fixed/adaptive: "          << result.polling.fixedTicks           << " / " << result.polling.adaptiveTicks        << "\n"
+        << "worst split latency ms: "        << result.polling.fixedWorstSplitMs    << " / " << result.polling.adaptiveWorstSplitMs << "\n"
+        << "worst load boundary latency ms: " << result.polling.fixedWorstLoadMs     << " / " << result.polling.adaptiveWorstLoadMs  << "\n";
+
+    for (const auto& split : result.splitChanges) {
+        out << "split " << split.splitIndex << " at " << clockText(split.time) << "\n";
+    }
+
+    return 0;
+
+}
 
 int main(int argc, char** argv) {
 
     setupSettings(loadSettings()); // valid setup is guaranteed by this call, even if the user provides invalid settings
+
+    if (argc >= 3 && std::string(argv[1]) == "--replay") return runReplay(argv[2]);
+
     setupVersionOffsets(); // might fail but timerworker module has its own extra check for this
 
-    std::thread workerThread([] { TimerWorker(); }); // Start TimerWorker on background thread
-    workerThread.detach(); // runs for program lifetime
+    startTimerWorker(); // on a background thread until stopTimerWorker()
+
+    if (settings.state_server_port) startStateServer(static_cast<uint16_t>(settings.state_server_port));
 
+    setPerfThreadName("gui");
     QApplication app(argc, argv);
     GridWidget widget;
     widget.show();
 
-    return app.exec();
+    const int rc = app.exec();
+    stopTimerWorker();
+    saveStats(widget.formatDisplayStats());
+    stopStateServer();
+    stopPerfTrace();
+    if (settings.shared_memory) unlinkSharedState();
+    return rc;
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,171 @@
+#include <charconv>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <cinttypes>
+#include <csignal>
+#include <string>
+#include <thread>
+#include <chrono>
+
+import Settings;
+import GameMemory;
+import TimerWorker;
+import PerfTracer;
+import StateServer;
+import SharedState;
+
+// nxTimerHeadless: the autosplitter and load remover without a window, for feeding other overlays and
+// loggers. Writes one JSON object per line:
+//
+//   {"type":"event","event":"split","split":3,"time_ns":81234567890,"at_ns":...,"error_ns":...}
+//   {"type":"state","split":3,"running":true,"paused":false,"time_ns":...,"error_ns":...,"at_ns":...}
+//   {"type":"dropped","count":2}
+//
+// time_ns is game time, at_ns the steady clock time it happened at, error_ns how far a load boundary
+// can be off (0 for key presses).
+//
+// usage: nxTimerHeadless [--out <file>] [--state-ms <n>] [--replay <trace.nxtrace> [--realtime]]
+
+static volatile std::sig_atomic_t stopRequested = 0;
+
+static void writeEvent(std::FILE* out, const TimerEvent_s& e) {
+
+    std::fprintf(out, "{\"type\":\"event\",\"event\":\"%s\",\"split\":%zu,\"time_ns\":%" PRId64 ",\"at_ns\":%" PRId64 ",\"error_ns\":%" PRId64 "}\n",
+                 timerEventName(e.kind), e.splitIndex, e.timeNs, e.timestampNs, e.errorNs);
+
+}
+
+static void writeState(std::FILE* out, size_t split, bool running, bool paused, int64_t timeNs, int64_t errorNs, int64_t atNs) {
+
+    std::fprintf(out, "{\"type\":\"state\",\"split\":%zu,\"running\":%s,\"paused\":%s,\"time_ns\":%" PRId64 ",\"error_ns\":%" PRId64 ",\"at_ns\":%" PRId64 "}\n",
+                 split, running ? "true" : "false", paused ? "true" : "false", timeNs, errorNs, atNs);
+
+}
+
+// "--state-ms" value: whole, non-negative milliseconds that still fit in nanoseconds, false otherwise
+static bool parseMilliseconds(const char* text, int64_t& ns) {
+
+    int64_t ms = 0;
+    const char* end = text + std::strlen(text);
+    const auto [ptr, ec] = std::from_chars(text, end, ms);
+    if (ec != std::errc() || ptr != end || ms < 0 || ms > INT64_MAX / 1'000'000) return false;
+    ns = ms * 1'000'000;
+    return true;
+
+}
+
+// Replays a trace, either as fast as possible or paced like the recording
+static int runReplay(std::FILE* out, const std::string& path, int64_t stateIntervalNs, bool realtime) {
+
+    const auto wallStart = std::chrono::steady_clock::now();
+    int64_t firstNs = -1;
+    int64_t nextStateNs = 0;
+
+    const ReplayResult_s result = replayTrace(path, [&](int64_t timestampNs, const TimerStep_s& step) {
+
+        if (firstNs < 0) {
+            firstNs = timestampNs;
+            nextStateNs = timestampNs;
+        }
+        if (realtime) std::this_thread::sleep_until(wallStart + std::chrono::nanoseconds(timestampNs - firstNs));
+
+        for (size_t i = 0; i < step.eventCount; ++i) writeEvent(out, step.events[i]);
+
+        if (stateIntervalNs > 0 && timestampNs >= nextStateNs) {
+            const TimerEngineState_s& s = step.state;
+            writeState(out, s.currentSplitIndex, s.timerRunning, s.gameTimePaused, s.accumulatedNs, s.errorBoundNs, timestampNs);
+            nextStateNs = timestampNs + stateIntervalNs;
+        }
+
+    });
+
+    return result.ok ? 0 : 1;
+
+}
+
+// Runs the worker against the game and streams what it publishes until SIGINT/SIGTERM
+static int runLive(std::FILE* out, int64_t stateIntervalNs) {
+
+    setupVersionOffsets(); // might fail but timerworker module has its own extra check for this
+
+    startTimerWorker();
+
+    if (settings.state_server_port && !startStateServer(static_cast<uint16_t>(settings.state_server_port))) {
+        std::fprintf(stderr, "state server: can't listen on 127.0.0.1:%d\n", settings.state_server_port);
+    }
+
+    // events carry their own times, so draining them every few ms only delays the output
+    const auto drainInterval = std::chrono::milliseconds(5);
+    auto nextState = std::chrono::steady_clock::now();
+    uint64_t seenDropped = 0;
+
+    while (!stopRequested) {
+
+        TimerEvent_s event;
+        while (popTimerEvent(event)) writeEvent(out, event);
+
+        if (const uint64_t dropped = droppedTimerEvents(); dropped != seenDropped) {
+            std::fprintf(out, "{\"type\":\"dropped\",\"count\":%" PRIu64 "}\n", dropped - seenDropped);
+            seenDropped = dropped;
+        }
+
+        const auto now = std::chrono::steady_clock::now();
+        if (stateIntervalNs > 0 && now >= nextState) {
+            const TimerSnapshot_s s = readTimerSnapshot();
+            writeState(out, s.currentSplitIndex, s.timerRunning, s.gameTimePaused, s.accumulatedNs, s.errorBoundNs, s.publishedNs);
+            nextState = now + std::chrono::nanoseconds(stateIntervalNs);
+        }
+
+        std::this_thread::sleep_for(drainInterval);
+
+    }
+
+    stopTimerWorker();
+    saveStats();
+    stopStateServer();
+    stopPerfTrace();
+    if (settings.shared_memory) unlinkSharedState();
+    return 0;
+
+}
+
+int main(int argc, char** argv) {
+
+    std::string outPath;
+    std::string replayPath;
+    int64_t stateIntervalNs = 0;
+    bool realtime = false;
+
+    for (int i = 1; i < argc; ++i) {
+
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+
+        if (arg == "--out" && hasValue)             outPath = argv[++i];
+        else if (arg == "--state-ms" && hasValue && parseMilliseconds(argv[i + 1], stateIntervalNs)) ++i;
+        else if (arg == "--replay" && hasValue)     replayPath = argv[++i];
+        else if (arg == "--realtime")               realtime = true;
+        else {
+            std::fprintf(stderr, "usage: %s [--out <file>] [--state-ms <n>] [--replay <trace.nxtrace> [--realtime]]\n", argv[0]);
+            return 2;
+        }
+
+    }
+
+    setupSettings(loadSettings()); // valid setup is guaranteed by this call, even if the user provides invalid settings
+
+    std::FILE* out = outPath.empty() ? stdout : std::fopen(outPath.c_str(), "w");
+    if (!out) return 1;
+    std::setvbuf(out, nullptr, _IOLBF, 1 << 12); // one line per write, readers see each event as it happens
+
+    std::signal(SIGINT,  [](int) { stopRequested = 1; });
+    std::signal(SIGTERM, [](int) { stopRequested = 1; });
+
+    const int rc = replayPath.empty() ? runLive(out, stateIntervalNs)
+                                      : runReplay(out, replayPath, stateIntervalNs, realtime);
+
+    if (out != stdout) std::fclose(out);
+    return rc;
+
+}
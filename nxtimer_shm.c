@@ -0,0 +1,195 @@
+/* Reader side of nxtimer_shm.h. Plain C, no dependencies beyond the OS, so it can be compiled into a
+ * plugin as is. */
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#define _POSIX_C_SOURCE 200809L
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#endif
+#include <string.h>
+
+#include "nxtimer_shm.h"
+
+/* The loads the protocol needs: relaxed word loads, an acquire load and an acquire fence */
+#if defined(__GNUC__) || defined(__clang__)
+#define LOAD_RELAXED(p)     __atomic_load_n((p), __ATOMIC_RELAXED)
+#define LOAD_ACQUIRE(p)     __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define LOAD_ACQUIRE32(p)   __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define FENCE_ACQUIRE()     __atomic_thread_fence(__ATOMIC_ACQUIRE)
+#elif defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+/* x64 never reorders loads with loads, only the compiler has to be held back */
+#define LOAD_RELAXED(p)     (*(const volatile uint64_t*)(p))
+#define LOAD_ACQUIRE(p)     (*(const volatile uint64_t*)(p))
+#define LOAD_ACQUIRE32(p)   (*(const volatile uint32_t*)(p))
+#define FENCE_ACQUIRE()     _ReadWriteBarrier()
+#else
+#error "nxtimer_shm.c needs GCC/Clang atomics or MSVC on x64"
+#endif
+
+/* A writer that died mid-write leaves the sequence odd for good; give up after this many tries */
+#define MAX_RETRIES 100000
+
+/* Copies 'words' 64-bit words of 'src', all loaded relaxed */
+static void copyWords(void* dst, const void* src, size_t words) {
+
+    const uint64_t* from = (const uint64_t*)src;
+    uint64_t* to = (uint64_t*)dst;
+    size_t i;
+    for (i = 0; i < words; ++i) to[i] = LOAD_RELAXED(&from[i]);
+
+}
+
+int nxtimer_open(nxtimer_reader* reader) {
+
+    const nxtimer_shm* shm;
+
+    memset(reader, 0, sizeof(*reader));
+
+#ifdef _WIN32
+    {
+        HANDLE mapping = OpenFileMappingA(FILE_MAP_READ, FALSE, NXTIMER_SHM_NAME);
+        if (!mapping) return -1;
+        shm = (const nxtimer_shm*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, NXTIMER_SHM_SIZE);
+        if (!shm) {
+            CloseHandle(mapping);
+            return -1;
+        }
+        reader->handle = mapping;
+    }
+#else
+    {
+        void* view;
+        struct stat st;
+        const int fd = shm_open(NXTIMER_SHM_NAME, O_RDONLY, 0);
+        if (fd < 0) return -1;
+        if (fstat(fd, &st) != 0 || st.st_size < (off_t)NXTIMER_SHM_SIZE) {
+            close(fd);
+            return -1;
+        }
+        view = mmap(NULL, NXTIMER_SHM_SIZE, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd); /* the mapping stays */
+        if (view == MAP_FAILED) return -1;
+        shm = (const nxtimer_shm*)view;
+    }
+#endif
+
+    reader->shm = shm;
+
+    /* magic is stored last, with release, once the rest of the header is in place */
+    if (LOAD_ACQUIRE32(&shm->magic) != NXTIMER_SHM_MAGIC ||
+        shm->version != NXTIMER_SHM_VERSION || shm->size < sizeof(nxtimer_shm) ||
+        shm->event_capacity != NXTIMER_SHM_EVENTS) {
+        nxtimer_close(reader);
+        return -1;
+    }
+
+    /* only events from here on */
+    reader->session = LOAD_ACQUIRE(&shm->session);
+    reader->next_event = LOAD_ACQUIRE(&shm->event_head);
+    return 0;
+
+}
+
+void nxtimer_close(nxtimer_reader* reader) {
+
+#ifdef _WIN32
+    if (reader->shm) UnmapViewOfFile(reader->shm);
+    if (reader->handle) CloseHandle((HANDLE)reader->handle);
+#else
+    if (reader->shm) munmap((void*)reader->shm, NXTIMER_SHM_SIZE);
+#endif
+    memset(reader, 0, sizeof(*reader));
+
+}
+
+uint64_t nxtimer_state_version(const nxtimer_reader* reader) {
+    return LOAD_ACQUIRE(&reader->shm->state_sequence);
+}
+
+int nxtimer_read_state(const nxtimer_reader* reader, nxtimer_state* out) {
+
+    const nxtimer_shm* shm = reader->shm;
+    int tries;
+
+    for (tries = 0; tries < MAX_RETRIES; ++tries) {
+
+        const uint64_t before = LOAD_ACQUIRE(&shm->state_sequence);
+        uint64_t after;
+        if (before & 1) continue;
+
+        copyWords(out, &shm->state, sizeof(nxtimer_state) / sizeof(uint64_t));
+        FENCE_ACQUIRE();
+        after = LOAD_RELAXED(&shm->state_sequence);
+        if (before == after) return 1;
+
+    }
+    return 0;
+
+}
+
+int nxtimer_next_event(nxtimer_reader* reader, nxtimer_event* out) {
+
+    const nxtimer_shm* shm = reader->shm;
+    const uint64_t session = LOAD_ACQUIRE(&shm->session);
+    uint64_t head;
+    int tries;
+
+    if (session != reader->session) {
+        reader->session = session;
+        reader->next_event = 0;
+        return -1;
+    }
+
+    for (tries = 0; tries < MAX_RETRIES; ++tries) {
+
+        const nxtimer_event* slot;
+        uint64_t stamp;
+
+        head = LOAD_ACQUIRE(&shm->event_head);
+        if (reader->next_event >= head) return 0;
+
+        /* lapped: skip to the oldest event still in the ring */
+        if (head - reader->next_event > NXTIMER_SHM_EVENTS) {
+            reader->next_event = head - NXTIMER_SHM_EVENTS;
+            return -1;
+        }
+
+        slot = &shm->events[reader->next_event % NXTIMER_SHM_EVENTS];
+        stamp = LOAD_ACQUIRE(&slot->stamp);
+        if (stamp != reader->next_event + 1) continue; /* being rewritten, head has moved on: try again */
+
+        copyWords(out, slot, sizeof(nxtimer_event) / sizeof(uint64_t));
+        FENCE_ACQUIRE();
+        if (LOAD_RELAXED(&slot->stamp) != stamp) continue;
+
+        ++reader->next_event;
+        return 1;
+
+    }
+    return 0;
+
+}
+
+int64_t nxtimer_now_ns(void) {
+
+#ifdef _WIN32
+    static LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+    if (!frequency.QuadPart) QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    /* split so the multiplication can't overflow after a few days of uptime */
+    return (int64_t)(counter.QuadPart / frequency.QuadPart) * 1000000000 +
+           (int64_t)(counter.QuadPart % frequency.QuadPart) * 1000000000 / frequency.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+#endif
+
+}
@@ -0,0 +1,133 @@
+/*
+ * nxTimer's shared-memory state segment, for native overlays and tools on the same machine.
+ *
+ * With shared_memory: ON the timer publishes every tick into a named segment: POSIX shared memory
+ * "/nxTimerState" on Linux, the file mapping "Local\nxTimerState" on Windows. The layout below is
+ * fixed for a given NXTIMER_SHM_VERSION; fields are only ever added at the end, into the reserved
+ * space, and 'size' tells how much of it a writer fills.
+ *
+ * One writer, any number of readers, no locks:
+ *
+ *  - state: a seqlock. The writer makes state_sequence odd, writes the state words and makes it even
+ *    again. A reader loads the sequence, copies the state, loads it again and keeps the copy only if
+ *    both loads were the same even number.
+ *  - events: a ring of the last NXTIMER_SHM_EVENTS events. Event n (counted from 0 since 'session'
+ *    began) goes to slot n % NXTIMER_SHM_EVENTS, whose 'stamp' is 0 while the writer fills it and
+ *    n + 1 after. event_head is the number of events written. A reader keeps its own cursor and
+ *    knows it lost events when event_head ran more than a ring ahead of it.
+ *
+ * Every word the protocol relies on is 64 bits and naturally aligned; 64-bit processes only. Times
+ * are nanoseconds of the monotonic clock both sides share (CLOCK_MONOTONIC, QueryPerformanceCounter),
+ * see nxtimer_now_ns().
+ *
+ * nxtimer_shm.c implements the reader side; link nxTimerShm or compile it into the consumer.
+ */
+
+#ifndef NXTIMER_SHM_H
+#define NXTIMER_SHM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define NXTIMER_SHM_MAGIC       0x5354584Eu     /* "NXTS" */
+#define NXTIMER_SHM_VERSION     1u
+#define NXTIMER_SHM_EVENTS      64u
+#define NXTIMER_SHM_SIZE        4096u
+
+#ifdef _WIN32
+#define NXTIMER_SHM_NAME        "Local\\nxTimerState"
+#else
+#define NXTIMER_SHM_NAME        "/nxTimerState"
+#endif
+
+/* nxtimer_event.kind, nxtimer_state.last_event */
+enum {
+    NXTIMER_EVENT_START,
+    NXTIMER_EVENT_SPLIT,
+    NXTIMER_EVENT_SKIP,
+    NXTIMER_EVENT_UNDO,
+    NXTIMER_EVENT_RESET,
+    NXTIMER_EVENT_PAUSE,
+    NXTIMER_EVENT_RESUME,
+    NXTIMER_EVENT_FINAL
+};
+
+/* What the timer window shows, as of one tick of the reading thread */
+typedef struct nxtimer_state {
+    int64_t     time_ns;        /* game time */
+    int64_t     error_ns;       /* time_ns is exact to within this */
+    int64_t     tick_ns;        /* when the tick that produced this read the game */
+    int64_t     last_event_ns;  /* when last_event happened */
+    int64_t     last_split_ns;  /* same for the last split, skip or final split */
+    uint64_t    split;          /* 0 before the start, 1 on the first split of the table */
+    uint8_t     running;
+    uint8_t     paused;         /* on a loading screen, or not started */
+    uint8_t     finished;       /* the final split is done, the total is shown */
+    uint8_t     last_event;
+    uint8_t     reserved[4];
+} nxtimer_state;
+
+typedef struct nxtimer_event {
+    uint64_t    stamp;          /* event number + 1, 0 while being written */
+    uint64_t    split;          /* index after the event */
+    int64_t     time_ns;        /* game time at the event */
+    int64_t     timestamp_ns;   /* when it happened */
+    int64_t     error_ns;       /* timestamp_ns is off by at most this */
+    uint32_t    kind;
+    uint32_t    reserved;
+} nxtimer_event;
+
+typedef struct nxtimer_shm {
+    /* written once when the writer creates the segment, magic last */
+    uint32_t        magic;
+    uint32_t        version;
+    uint32_t        size;               /* bytes the writer fills, sizeof(nxtimer_shm) for this version */
+    uint32_t        event_capacity;
+    uint64_t        session;            /* changes whenever a writer starts over, cursors must be reset */
+    uint8_t         reserved0[40];
+
+    uint64_t        state_sequence;     /* offset 64 */
+    uint8_t         reserved1[56];
+    nxtimer_state   state;              /* offset 128 */
+
+    uint8_t         reserved2[8];
+    uint64_t        event_head;         /* offset 192 */
+    uint8_t         reserved3[56];
+    nxtimer_event   events[NXTIMER_SHM_EVENTS];  /* offset 256 */
+} nxtimer_shm;
+
+/* Reader side (nxtimer_shm.c) */
+
+typedef struct nxtimer_reader {
+    const nxtimer_shm*  shm;
+    uint64_t            session;
+    uint64_t            next_event;     /* number of the next event to return */
+    void*               handle;
+} nxtimer_reader;
+
+/* Maps the segment read-only. 0 on success, -1 if there is no segment or it has another version. */
+int nxtimer_open(nxtimer_reader* reader);
+void nxtimer_close(nxtimer_reader* reader);
+
+/* Bumped by 2 per published tick: poll this and read the state only when it changed */
+uint64_t nxtimer_state_version(const nxtimer_reader* reader);
+
+/* 1 with a consistent copy of the state, 0 if the writer stayed in the middle of a write (it died there) */
+int nxtimer_read_state(const nxtimer_reader* reader, nxtimer_state* out);
+
+/* 1 with the next event, 0 if there is none yet, -1 if events were lost (the writer lapped the
+   reader or restarted); the cursor then continues with the oldest event still in the ring */
+int nxtimer_next_event(nxtimer_reader* reader, nxtimer_event* out);
+
+/* The clock tick_ns and the event timestamps are on */
+int64_t nxtimer_now_ns(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif